@@ -0,0 +1,232 @@
+// Classe AutoTune : recherche du profil vitesse/accélération le plus rapide sans perte de pas.
+// - Une course = ouverture complète puis fermeture jusqu'au fin de course, au profil candidat.
+// - Contrôle : la position comptée au déclenchement du fin de course doit valoir 0 (± tolérance),
+//   sinon des pas ont été perdus. Fin de course introuvable -> retour lent jusqu'au switch.
+// - Montée par paliers (x stepFactor) puis dichotomie entre dernier succès et premier échec :
+//   accélération tant que la vitesse max n'est pas atteinte dans la course, vitesse ensuite.
+// - Pause entre les courses (lecture température Nano, WebUI) ; trop chaud -> recherche arrêtée.
+// - Déclassement thermique suspendu pendant la recherche (sinon le profil essayé n'est pas celui
+//   demandé) ; tempMaxC tient lieu de garde. Rétabli sur TUNE_DONE / TUNE_FAILED ; sur STOP,
+//   à la charge de l'appelant (restoreAxisProfile() dans FSM.h).
+// - Résultat = dernier profil sûr (marge retirée sur une dimension en échec seulement, jamais
+//   sous le profil de départ), validé par quelques courses.
+// Indépendant du FSM (tick() à chaque loop) pour être simulé sur PC (tools/autotune_sim.cpp).
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "CounterControl.h"
+
+struct AutoTuneConfig {
+  float   stepFactor      = TUNE_STEP_FACTOR;
+  float   resolution      = TUNE_RESOLUTION;
+  float   margin          = TUNE_MARGIN;
+  float   vmaxLimit       = TUNE_VMAX_LIMIT_REV_S * kStepsPerRev;                   // pas/s
+  float   accelLimit      = TUNE_ACCEL_LIMIT_REV_S2 * kStepsPerRev;                 // pas/s²
+  long    tolSteps        = TUNE_TOL_STEPS;
+  long    overtravelSteps = (long)(TUNE_OVERTRAVEL_TURNS * kStepsPerRev);
+  float   tempMaxC        = TUNE_TEMP_MAX_C;
+  uint8_t confirmStrokes  = TUNE_CONFIRM_STROKES;
+  unsigned long dwellMs   = 500;                                                     // pause entre courses
+};
+
+// Valeur de retour de tick()
+enum AutoTuneEvent : uint8_t {
+  TUNE_BUSY,         // mouvement ou pause en cours
+  TUNE_STROKE_OK,    // course terminée sans perte (lastError(), lastPeak())
+  TUNE_STROKE_LOST,  // course terminée avec perte de pas
+  TUNE_DONE,         // résultat validé : resultSpeed() / resultAccel()
+  TUNE_FAILED        // profil de départ non fiable, ou fin de course introuvable (lostReference())
+};
+
+class AutoTune {
+public:
+  void begin(CounterControl& ctrl, float vStart, float aStart, const AutoTuneConfig& cfg = AutoTuneConfig()) {
+    _c = &ctrl;
+    _cfg = cfg;
+    _vStart = vStart;
+    _aStart = aStart;
+    _v = { vStart, 0.0f };
+    _a = { aStart, 0.0f };
+    _vCand = vStart;
+    _aCand = aStart;
+    _validated = false;
+    _peakReached = false;
+    _tempLimited = false;
+    _lostRef = false;
+    _confirming = 0;
+    _raising = DIM_NONE;
+    _c->setDerateEnabled(false);
+    startStroke();
+  }
+
+  uint8_t tick(float tempC) {
+    if (_c->isMoving()) return TUNE_BUSY;
+    switch (_step) {
+      case ST_OPEN:
+        startClose();
+        return TUNE_BUSY;
+
+      case ST_CLOSE: {
+        bool hit = _c->lastCalibMs() != _calibSeen;
+        _lastErr = hit ? _c->lastCalibPos() : -_cfg.overtravelSteps;
+        _lastPeak = _c->motor.peakSpeed();
+        bool lost = !hit || labs(_lastErr) > _cfg.tolSteps;
+        uint8_t ev = decide(lost);
+        if (!hit) startRecover();
+        else startDwell();
+        return ev;
+      }
+
+      case ST_RECOVER:
+        if (_c->lastCalibMs() == _calibSeen) { _lostRef = true; return finish(TUNE_FAILED); }
+        startDwell();
+        return TUNE_BUSY;
+
+      case ST_DWELL:
+        if (millis() - _dwellStartMs < _cfg.dwellMs) return TUNE_BUSY;
+        // Marge thermique : plus de montée, on valide le dernier profil sûr
+        if (!_confirming && _after == AFTER_NEXT && tempC > _cfg.tempMaxC) {
+          _tempLimited = true;
+          startConfirm();
+        }
+        if (_after == AFTER_FAIL) return finish(TUNE_FAILED);
+        if (_after == AFTER_DONE) return finish(TUNE_DONE);
+        startStroke();
+        return TUNE_BUSY;
+
+      case ST_END:
+      default:
+        return TUNE_BUSY;
+    }
+  }
+
+  // Profil de la course en cours / résultat (valide après TUNE_DONE), en pas/s et pas/s²
+  float candidateSpeed() const { return _vCand; }
+  float candidateAccel() const { return _aCand; }
+  float resultSpeed() const    { return _vCand; }
+  float resultAccel() const    { return _aCand; }
+  // Dernière course : profil essayé (pas/s, pas/s²)
+  float lastSpeed() const      { return _lastV; }
+  float lastAccel() const      { return _lastA; }
+  // Dernière course : position comptée au déclenchement du fin de course (0 = aucun pas perdu), pic de vitesse
+  long  lastError() const      { return _lastErr; }
+  float lastPeak() const       { return _lastPeak; }
+  bool  confirming() const     { return _confirming > 0; }
+  bool  tempLimited() const    { return _tempLimited; }
+  bool  lostReference() const  { return _lostRef; }
+
+private:
+  enum Step : uint8_t { ST_OPEN, ST_CLOSE, ST_RECOVER, ST_DWELL, ST_END };
+  enum After : uint8_t { AFTER_NEXT, AFTER_DONE, AFTER_FAIL };
+  enum DimId : uint8_t { DIM_NONE, DIM_V, DIM_A };
+
+  // Une dimension de recherche : dernier succès, premier échec (0 = aucun)
+  struct Dim {
+    float good, bad;
+    float next(float factor, float limit) const {
+      float x = (bad > 0.0f) ? sqrtf(good * bad) : good * factor;
+      return x > limit ? limit : x;
+    }
+    bool closed(float resolution, float limit) const {
+      return good >= limit || (bad > 0.0f && bad < good * resolution);
+    }
+  };
+
+  // Met à jour la recherche après une course ; fixe _after et le profil suivant
+  uint8_t decide(bool lost) {
+    _lastV = _vCand;
+    _lastA = _aCand;
+    _after = AFTER_NEXT;
+    if (_confirming) {
+      if (lost) _after = AFTER_FAIL;              // résultat avec marge non confirmé
+      else if (--_confirming == 0) _after = AFTER_DONE;
+      return lost ? TUNE_STROKE_LOST : TUNE_STROKE_OK;
+    }
+
+    if (lost) {
+      if (!_validated) { _after = AFTER_FAIL; return TUNE_STROKE_LOST; }  // profil de départ non fiable
+      if (_raising == DIM_V) _v.bad = _vCand;
+      else                   _a.bad = _aCand;
+      _vCand = _v.good;
+      _aCand = _a.good;
+    } else {
+      // Vitesse validée = vitesse réellement atteinte pendant la course, pas le plafond demandé
+      _validated = true;
+      _peakReached = _lastPeak >= 0.95f * _vCand;
+      _v.good = _peakReached ? _vCand : fmaxf(_v.good, fminf(_vCand, _lastPeak));
+      _a.good = _aCand;
+    }
+
+    // Vitesse non atteinte : seule l'accélération peut encore progresser
+    bool vOpen = !_v.closed(_cfg.resolution, _cfg.vmaxLimit) && _peakReached;
+    bool aOpen = !_a.closed(_cfg.resolution, _cfg.accelLimit);
+    if (aOpen && (!_peakReached || !vOpen)) { _raising = DIM_A; _aCand = _a.next(_cfg.stepFactor, _cfg.accelLimit); }
+    else if (vOpen)                         { _raising = DIM_V; _vCand = _v.next(_cfg.stepFactor, _cfg.vmaxLimit); }
+    else startConfirm();
+    return lost ? TUNE_STROKE_LOST : TUNE_STROKE_OK;
+  }
+
+  // Marge uniquement sur une dimension qui a déjà échoué ; jamais sous le profil de départ
+  void startConfirm() {
+    _vCand = backOff(_v, _vStart);
+    _aCand = backOff(_a, _aStart);
+    _confirming = _cfg.confirmStrokes;
+    _after = _confirming ? AFTER_NEXT : AFTER_DONE;
+  }
+
+  float backOff(const Dim& d, float start) const {
+    if (d.bad <= 0.0f) return d.good;
+    return fmaxf(d.good * (1.0f - _cfg.margin), start);
+  }
+
+  // Fin de recherche : déclassement rétabli (appliqué tout de suite, l'axe est à l'arrêt)
+  uint8_t finish(uint8_t ev) {
+    _step = ST_END;
+    _c->setDerateEnabled(true);
+    return ev;
+  }
+
+  void startStroke() {
+    _c->setMaxSpeedSteps(_vCand);
+    _c->setAccelerationSteps2(_aCand);
+    _c->motor.resetPeak();
+    _c->motor.setDirection(1);
+    _c->open();
+    _step = ST_OPEN;
+  }
+
+  // Fermeture au-delà de 0 : le fin de course doit arrêter le moteur à 0 pile
+  void startClose() {
+    _calibSeen = _c->lastCalibMs();
+    _c->motor.setDirection(-1);
+    _c->motor.moveTo(-_cfg.overtravelSteps);
+    _step = ST_CLOSE;
+  }
+
+  // Fin de course non trouvé : retour lent (mêmes réglages que le homing lent)
+  void startRecover() {
+    _calibSeen = _c->lastCalibMs();
+    _c->setMaxSpeedSteps(1200);
+    _c->setAccelerationSteps2(40);
+    _c->motor.setDirection(-1);
+    _c->motor.move(-kHomingTravel);
+    _step = ST_RECOVER;
+  }
+
+  void startDwell() {
+    _dwellStartMs = millis();
+    _step = ST_DWELL;
+  }
+
+  CounterControl* _c = nullptr;
+  AutoTuneConfig _cfg;
+  Dim _v = { 0.0f, 0.0f }, _a = { 0.0f, 0.0f };
+  float _vCand = 0.0f, _aCand = 0.0f, _vStart = 0.0f, _aStart = 0.0f;
+  uint8_t _step = ST_END, _after = AFTER_NEXT, _raising = DIM_NONE, _confirming = 0;
+  bool _validated = false, _peakReached = false, _tempLimited = false, _lostRef = false;
+
+  long _lastErr = 0;
+  float _lastPeak = 0.0f, _lastV = 0.0f, _lastA = 0.0f;
+  unsigned long _calibSeen = 0, _dwellStartMs = 0;
+};
@@ -8,6 +8,23 @@
 #define LIMIT_BOTTOM 5  // D1 (pull-up interne)
 #define BUTTON_PIN 4  // D2, (pull-up interne)
 
+// ---- Axes (compteurs pilotés par cet ESP8266, servis par StepScheduler) ----
+// Le bouton physique commande l'axe 0. GPIO16 (D0) n'a pas de pull-up interne.
+#define AXIS_COUNT 1
+struct AxisPins { uint8_t step, dir; int8_t ena; uint8_t limit; };
+static const AxisPins kAxisPins[AXIS_COUNT] = {
+  { STEP_PIN, DIR_PIN, ENA_PIN, LIMIT_BOTTOM },
+  // { 15 /*D8*/, 0 /*D3*/, -1, 16 /*D0*/ },   // exemple de 2e axe (AXIS_COUNT 2)
+};
+// WebUI pendant qu'un axe bouge. Désactivé par défaut avec un seul axe : rien n'est servi avant
+// l'arrêt (le bouton physique reste le STOP en course) et les pas gardent leur régularité.
+// Activé : un client au plus toutes les WEBUI_MOVING_POLL_MS (STOP, commandes des autres axes,
+// /status, /done) ; page, /logs, /cycles et /trace.bin répondent 503 jusqu'à l'arrêt.
+// Coût mesuré sur le banc hôte : une requête servie retarde les pas jusqu'à ~10 ms (max 9,9 ms ;
+// 29 pas à plus de 25 % de leur intervalle sur une fermeture de 0,74 s avec quelques requêtes).
+static const bool WEBUI_SERVE_WHILE_MOVING = AXIS_COUNT > 1;
+static const unsigned long WEBUI_MOVING_POLL_MS = 100UL;
+
 // -------------------- Paramètres WIFI --------------------
 #define WIFI_SSID "TELUS0382"
 #define WIFI_PWD  "gmg7n3qqzh"
@@ -29,6 +46,39 @@ static float       kVmaxSteps     = VMAX_REV_S_DEFAULT   * kStepsPerRev;
 static float       kAccelSteps2   = ACCEL_REV_S2_DEF     * kStepsPerRev * kStepsPerRev;
 
 
+// ---- Zones de vitesse (en tours depuis le fin de course bas) ----
+// Approche lente sur les ZONE_END_TURNS derniers tours de chaque extrémité ; la vitesse
+// réglée par /set ne s'applique qu'en milieu de course.
+static const float ZONE_END_TURNS      = 0.3f;
+static const float ZONE_END_VMAX_REV_S = VMAX_REV_S_DEFAULT;  // vitesse sûre près des butées
+
+// ---- Driver : coupure du courant de maintien au repos + déclassement thermique ----
+// Coupure d'ENABLE après DRIVER_IDLE_OFF_MS sans mouvement (0 = toujours alimenté, défaut).
+// Crémaillère verticale avec un seul fin de course bas : sans courant de maintien la charge peut
+// glisser, et rien ne vérifie ni ne refait le homing à la réactivation -> position comptée fausse.
+// Ne l'activer (ex. 10000UL) que si la charge tient seule (frein, réducteur irréversible).
+// Réactivation : DRIVER_SETTLE_MS avant le 1er pas.
+static const unsigned long DRIVER_IDLE_OFF_MS = 0UL;
+static const unsigned long DRIVER_SETTLE_MS   = 20UL;
+// Courbe température moteur (Nano, °C) -> facteur sur vitesse max et accélération, interpolée
+// linéairement ; pleine vitesse sous le premier point, dernier facteur au-delà du dernier.
+struct DeratePoint { float tempC; float factor; };
+static const DeratePoint kDerateCurve[] = { { 50.0f, 1.0f }, { 70.0f, 0.6f }, { 80.0f, 0.3f } };
+static const uint8_t kDerateCurveLen = sizeof(kDerateCurve) / sizeof(kDerateCurve[0]);
+
+// ---- Autotune : recherche du profil vitesse/accélération le plus rapide sans perte de pas ----
+// Courses aller-retour ; la fermeture va chercher le fin de course (jusqu'à TUNE_OVERTRAVEL_TURNS
+// sous 0) et l'écart de position au déclenchement mesure les pas perdus.
+static const float   TUNE_STEP_FACTOR        = 1.5f;   // palier de montée (x1.5), puis dichotomie
+static const float   TUNE_RESOLUTION         = 1.05f;  // recherche close quand échec/succès < 5 %
+static const float   TUNE_MARGIN             = 0.20f;  // résultat = 80 % du dernier profil sûr
+static const float   TUNE_VMAX_LIMIT_REV_S   = 4.0f;   // plafonds de recherche
+static const float   TUNE_ACCEL_LIMIT_REV_S2 = 20.0f;
+static const long    TUNE_TOL_STEPS          = 10;     // répétabilité du fin de course
+static const float   TUNE_OVERTRAVEL_TURNS   = 0.5f;
+static const float   TUNE_TEMP_MAX_C         = 60.0f;  // température moteur (Nano) à ne pas dépasser
+static const uint8_t TUNE_CONFIRM_STROKES    = 2;      // courses de validation du résultat
+
 // Homing: déplacement négatif "sûr" jusqu’au fin de course bas (D1, PULLUP)
 // Valeurs pour le homing : déplacement sûr et délai maximum
 const long  kHomingTravel  = kStepsPerRev * 40L;   // marge généreuse
@@ -41,4 +91,12 @@ const unsigned long kHomingTimeoutMs = 30000UL;
 //static const bool KISS_USE_FAST_GPIO = true; // GPOS/GPOC sur ESP8266
 static const uint8_t KISS_MIN_PULSE_US = 6;  // DM556 >=5µs
 
+// Trace des pas (téléchargeable via /trace.bin) : 1 événement par pas, 1024 événements = 4 Ko
+// de RAM, soit ≈ 0,65 s à 0,8 tr/s (1600 pas/s) : la rampe d'accélération d'une course, pas la
+// course entière (≈ 7200 pas). /trace?on=1&once=1 s'arrête quand l'anneau est plein et garde
+// donc le début de la course suivante ; sans once, l'anneau garde les derniers pas.
+#ifndef KISS_TRACE_DEPTH
+  #define KISS_TRACE_DEPTH 1024
+#endif
+
 
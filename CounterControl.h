@@ -1,21 +1,266 @@
-#include <Arduino.h>
-
-void setup() {
-  Serial.begin(115200);
-  delay(1500);
-  Serial.println("Pico OK");
-
-#if defined(LED_BUILTIN)
-  pinMode(LED_BUILTIN, OUTPUT);
-#endif
-  pinMode(2, OUTPUT);   // GP2 sur ton breakout (LED status devrait réagir)
-}
-
-void loop() {
-#if defined(LED_BUILTIN)
-  digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-#endif
-  digitalWrite(2, !digitalRead(2));
-  Serial.println("tick");
-  delay(500);
-}
\ No newline at end of file
+// Classe CounterControl : surcouche moteur du comptoir.
+// - StepperKiss + fin de course bas (référence zéro) + bouton physique.
+// - Conversion tours <-> pas, vitesses en pas/s.
+// - Zones de vitesse dépendantes de la position (en tours depuis le fin de course).
+// - Driver : ENABLE coupé après un temps de repos, réactivé (avec délai) au mouvement suivant.
+// - Déclassement thermique : vitesse/accélération max x facteur(température), appliqué à l'arrêt.
+// - poll() : limites, bouton, puis run() du stepper (à appeler à chaque loop()).
+//   Avec plusieurs axes, StepScheduler appelle pollInputs() puis run() séparément.
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+#include "StepperKiss.h"
+
+// Anti-rebond du bouton physique
+#ifndef CC_BUTTON_DEBOUNCE_MS
+  #define CC_BUTTON_DEBOUNCE_MS 30UL
+#endif
+
+// Zone de vitesse : entre fromTurns et toTurns, vitesse plafonnée à vmaxSteps (pas/s)
+struct SpeedZone {
+  float fromTurns;
+  float toTurns;
+  float vmaxSteps;
+};
+
+// Table du comptoir (firmware et simulations) : vitesse ZONE_END_VMAX_REV_S sur les
+// ZONE_END_TURNS de chaque extrémité, bornes larges hors course. Remplit zones, renvoie le nombre.
+static const uint8_t kDefaultZoneCount = 2;
+static inline uint8_t defaultSpeedZones(SpeedZone* zones, float openTurns) {
+  const float endV = ZONE_END_VMAX_REV_S * kStepsPerRev;
+  zones[0] = { -1000.0f,                  ZONE_END_TURNS, endV };
+  zones[1] = { openTurns - ZONE_END_TURNS, 1000.0f,       endV };
+  return kDefaultZoneCount;
+}
+
+class CounterControl {
+public:
+  StepperKiss motor;
+
+  void begin(uint8_t stepPin, uint8_t dirPin, int8_t enaPin, bool enaActiveLow,
+             uint8_t limitPin, bool limitActiveLow, long stepsPerRev, float openTurns) {
+    motor.begin(stepPin, dirPin, enaPin, enaActiveLow);
+    motor.enable(true);
+    _hasEna = enaPin >= 0;
+    _lastMoveMs = millis();
+
+    _limitPin = limitPin;
+    _limitActiveLow = limitActiveLow;
+    pinMode(_limitPin, _limitActiveLow ? INPUT_PULLUP : INPUT);
+
+    _stepsPerRev = stepsPerRev > 0 ? stepsPerRev : 1;
+    setOpenTurns(openTurns);
+  }
+
+  // Bouton physique (pull-up interne, actif bas) ; un seul axe le porte.
+  void attachButton(uint8_t pin) {
+    _buttonPin = (int8_t)pin;
+    pinMode(pin, INPUT_PULLUP);
+  }
+
+  // ---- Paramètres ----
+  void setOpenTurns(float turns)          { _openSteps = lroundf(turns * (float)_stepsPerRev); }
+  // Valeurs nominales ; le moteur reçoit nominal x derateFactor()
+  void setMaxSpeedSteps(float sps)        { _vmaxNominal = sps;   applyLimits(); }
+  void setAccelerationSteps2(float sps2)  { _accelNominal = sps2; applyLimits(); }
+
+  // ---- Driver ----
+  // idleMs = 0 : jamais coupé. Sans broche ENABLE : sans effet.
+  void setDriverIdle(unsigned long idleMs, unsigned long settleMs) {
+    _idleOffMs = idleMs;
+    _settleMs = settleMs;
+  }
+  bool driverEnabled() const { return !_hasEna || motor.enabled(); }
+
+  // ---- Déclassement thermique ----
+  // Table non copiée (tableau constant, ex. kDerateCurve), températures croissantes.
+  void setDerateCurve(const DeratePoint* curve, uint8_t n) {
+    _curve = curve;
+    _curveLen = curve ? n : 0;
+  }
+  // Dernière température moteur lue ; le nouveau facteur est appliqué au prochain arrêt
+  // (le changer en mouvement plafonnerait la vitesse d'un coup).
+  void setTemperature(float tempC) {
+    float f = 1.0f;
+    if (_curveLen) {
+      f = _curve[_curveLen - 1].factor;
+      if (tempC <= _curve[0].tempC) f = _curve[0].factor;
+      else for (uint8_t i = 1; i < _curveLen; i++) {
+        if (tempC > _curve[i].tempC) continue;
+        const DeratePoint& p = _curve[i - 1];
+        const DeratePoint& q = _curve[i];
+        f = p.factor + (q.factor - p.factor) * (tempC - p.tempC) / (q.tempC - p.tempC);
+        break;
+      }
+    }
+    _derateWanted = constrain(f, 0.05f, 1.0f);
+  }
+  // Facteur effectivement appliqué au moteur (1 si le déclassement est suspendu)
+  float derateFactor() const { return _derateOn ? _derate : 1.0f; }
+  // Suspend le déclassement (AutoTune : le profil essayé doit être celui qu'il a demandé).
+  // La courbe et la température restent suivies ; effet immédiat, à appeler à l'arrêt.
+  void setDerateEnabled(bool on) {
+    _derateOn = on;
+    applyLimits();
+  }
+
+  // Remplace la table des zones (copiée, au plus KISS_MAX_ZONES). n = 0 : aucune zone.
+  void setSpeedZones(const SpeedZone* zones, uint8_t n) {
+    if (n > KISS_MAX_ZONES) n = KISS_MAX_ZONES;
+    for (uint8_t i = 0; i < n; i++) _zones[i] = zones[i];
+    _zoneCount = n;
+    applyZones();
+  }
+  // Désactivées pendant homing/mesure : la position n'y est pas encore fiable.
+  void enableSpeedZones(bool on) {
+    _zonesOn = on;
+    applyZones();
+  }
+
+  // ---- Mouvements ----
+  void open()  { motor.moveTo(_openSteps); }
+  void close() { motor.moveTo(0); }
+  void stop()  { motor.stop(); }
+
+  bool isMoving() const { return motor.currentPosition() != motor.targetPosition(); }
+
+  long  positionSteps() const { return motor.currentPosition(); }
+  float positionTurns() const { return (float)motor.currentPosition() / (float)_stepsPerRev; }
+
+  // Dernière prise de référence sur le fin de course : instant et pas parcourus depuis le début du mouvement
+  unsigned long lastCalibMs() const { return _lastCalibMs; }
+  long lastCalibSteps() const { return _lastCalibSteps; }
+  // Position comptée au déclenchement, avant remise à 0 : écart accumulé depuis la référence précédente
+  long lastCalibPos() const { return _lastCalibPos; }
+
+  // Retourne true une seule fois par appui (front descendant, anti-rebond)
+  bool readButton() {
+    bool ev = _btnEvent;
+    _btnEvent = false;
+    return ev;
+  }
+
+  void poll() {
+    pollInputs();
+    if (!settling()) motor.run();
+  }
+
+  // Fin de course + bouton + driver, sans faire avancer le moteur
+  void pollInputs() {
+    // Début d'un mouvement : mémoriser la position de départ (pour lastCalibSteps)
+    bool moving = isMoving();
+    if (moving && !_wasMoving) _moveStartPos = motor.currentPosition();
+    _wasMoving = moving;
+
+    serviceDriver(moving);
+    serviceLimit(moving);
+    serviceButtonInput();
+  }
+
+  // Vrai pendant le délai de réactivation du driver : aucun pas ne doit partir
+  bool settling() const { return _settling; }
+
+  // Vrai si run() a quelque chose à faire : pas échu, ou mouvement pas encore planifié
+  bool stepDue(unsigned long nowUs) const {
+    if (_settling) return false;
+    unsigned long next = motor.nextStepUs();
+    return next == 0 || (long)(nowUs - next) >= 0;
+  }
+
+private:
+  bool readLimit() const {
+    bool level = digitalRead(_limitPin) == HIGH;
+    return _limitActiveLow ? !level : level;
+  }
+
+  // Coupure au repos / réactivation ; facteur thermique appliqué seulement à l'arrêt
+  void serviceDriver(bool moving) {
+    unsigned long now = millis();
+    if (moving) {
+      _lastMoveMs = now;
+      if (_hasEna && !motor.enabled()) {
+        motor.enable(true);
+        _settling = _settleMs > 0;
+        _settleStartMs = now;
+      } else if (_settling && now - _settleStartMs >= _settleMs) {
+        _settling = false;
+      }
+      return;
+    }
+    _settling = false;
+    if (_derateWanted != _derate) { _derate = _derateWanted; applyLimits(); }
+    if (_hasEna && _idleOffMs && motor.enabled() && now - _lastMoveMs >= _idleOffMs) motor.enable(false);
+  }
+
+  void applyLimits() {
+    motor.setMaxSpeed(_vmaxNominal * derateFactor());
+    motor.setAcceleration(_accelNominal * derateFactor());
+  }
+
+  // Fin de course actif en descente -> arrêt immédiat et position = 0
+  void serviceLimit(bool moving) {
+    if (!moving || motor.direction() >= 0 || !readLimit()) return;
+    _lastCalibSteps = motor.currentPosition() - _moveStartPos;
+    _lastCalibPos = motor.currentPosition();
+    motor.emergencyStop();
+    motor.setCurrentPosition(0);
+    motor.moveTo(0);
+    _lastCalibMs = millis();
+    _wasMoving = false;
+  }
+
+  void serviceButtonInput() {
+    if (_buttonPin < 0) return;
+    bool pressed = digitalRead((uint8_t)_buttonPin) == LOW;
+    unsigned long now = millis();
+    if (pressed != _btnRaw) {
+      _btnRaw = pressed;
+      _btnChangeMs = now;
+    } else if (pressed != _btnStable && (now - _btnChangeMs) >= CC_BUTTON_DEBOUNCE_MS) {
+      _btnStable = pressed;
+      if (pressed) _btnEvent = true;
+    }
+  }
+
+  void applyZones() {
+    KissZone z[KISS_MAX_ZONES];
+    uint8_t n = _zonesOn ? _zoneCount : 0;
+    for (uint8_t i = 0; i < n; i++) {
+      z[i].from = lroundf(_zones[i].fromTurns * (float)_stepsPerRev);
+      z[i].to   = lroundf(_zones[i].toTurns   * (float)_stepsPerRev);
+      z[i].vmax = _zones[i].vmaxSteps;
+    }
+    motor.setZones(z, n);
+  }
+
+  uint8_t _limitPin = 255;
+  bool    _limitActiveLow = true;
+
+  long _stepsPerRev = 1;
+  long _openSteps = 0;
+
+  long _moveStartPos = 0;
+  bool _wasMoving = false;
+  unsigned long _lastCalibMs = 0;
+  long _lastCalibSteps = 0;
+  long _lastCalibPos = 0;
+
+  int8_t _buttonPin = -1;
+  bool _btnRaw = false, _btnStable = false, _btnEvent = false;
+  unsigned long _btnChangeMs = 0;
+
+  float _vmaxNominal = 2000.0f, _accelNominal = 2000.0f;  // mêmes défauts que StepperKiss
+  const DeratePoint* _curve = nullptr;
+  uint8_t _curveLen = 0;
+  float _derate = 1.0f, _derateWanted = 1.0f;
+  bool _derateOn = true;
+
+  bool _hasEna = false, _settling = false;
+  unsigned long _idleOffMs = 0, _settleMs = 0;
+  unsigned long _lastMoveMs = 0, _settleStartMs = 0;
+
+  SpeedZone _zones[KISS_MAX_ZONES];
+  uint8_t _zoneCount = 0;
+  bool _zonesOn = true;
+};
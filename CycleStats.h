@@ -0,0 +1,153 @@
+// Classe CycleStats : historique des courses OPENING/CLOSING d'un axe.
+// - Anneau fixe de CYCLE_RING_SIZE entrées compactes (durée, pas, pic de vitesse, T°, événements).
+// - Agrégats glissants par sens (moyenne, p95, tendance) mis à jour en O(1) à chaque course :
+//   l'export ne recalcule rien, il relit l'anneau et les agrégats.
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef CYCLE_RING_SIZE
+  #define CYCLE_RING_SIZE 32
+#endif
+
+// Événements survenus pendant la course
+enum : uint8_t { CYC_EV_STOPPED = 1, CYC_EV_REVERSED = 2 };
+
+struct CycleEntry {
+  uint32_t seq;           // numéro de course (tous sens)
+  uint32_t durationMs;
+  uint32_t steps;
+  uint16_t peakPermille;  // pic de vitesse atteint / vmax configurée (‰)
+  int16_t  tempDeciC;     // dernière température Nano (0.1 °C)
+  uint8_t  opening;       // 1 ouverture, 0 fermeture
+  uint8_t  events;        // CYC_EV_*
+};
+
+// Estimateur P² (Jain & Chlamtac) d'un quantile : 5 marqueurs, O(1) par échantillon, sans historique.
+class P2Quantile {
+public:
+  explicit P2Quantile(float p = 0.95f) : _p(p) {}
+
+  void add(float x) {
+    if (_n < 5) {
+      _q[_n++] = x;
+      if (_n == 5) {
+        for (uint8_t i = 1; i < 5; i++)   // tri des 5 premières valeurs
+          for (uint8_t j = i; j > 0 && _q[j - 1] > _q[j]; j--) { float t = _q[j]; _q[j] = _q[j - 1]; _q[j - 1] = t; }
+        for (uint8_t i = 0; i < 5; i++) _pos[i] = (float)(i + 1);
+        _des[0] = 1.0f; _des[1] = 1.0f + 2.0f * _p; _des[2] = 1.0f + 4.0f * _p; _des[3] = 3.0f + 2.0f * _p; _des[4] = 5.0f;
+      }
+      return;
+    }
+    _n++;
+
+    uint8_t k;
+    if (x < _q[0])       { _q[0] = x; k = 0; }
+    else if (x >= _q[4]) { _q[4] = x; k = 3; }
+    else { k = 0; while (x >= _q[k + 1]) k++; }
+    for (uint8_t i = k + 1; i < 5; i++) _pos[i] += 1.0f;
+    _des[1] += _p * 0.5f; _des[2] += _p; _des[3] += (1.0f + _p) * 0.5f; _des[4] += 1.0f;
+
+    for (uint8_t i = 1; i <= 3; i++) {
+      float d = _des[i] - _pos[i];
+      if ((d >= 1.0f && _pos[i + 1] - _pos[i] > 1.0f) || (d <= -1.0f && _pos[i - 1] - _pos[i] < -1.0f)) {
+        int s = (d >= 0.0f) ? 1 : -1;
+        float qp = _q[i] + s / (_pos[i + 1] - _pos[i - 1])
+                   * ((_pos[i] - _pos[i - 1] + s) * (_q[i + 1] - _q[i]) / (_pos[i + 1] - _pos[i])
+                    + (_pos[i + 1] - _pos[i] - s) * (_q[i] - _q[i - 1]) / (_pos[i] - _pos[i - 1]));
+        if (_q[i - 1] < qp && qp < _q[i + 1]) _q[i] = qp;
+        else _q[i] += s * (_q[i + s] - _q[i]) / (_pos[i + s] - _pos[i]);  // repli linéaire
+        _pos[i] += s;
+      }
+    }
+  }
+
+  float value() const {
+    if (_n >= 5) return _q[2];
+    if (_n == 0) return 0.0f;
+    float s[5];  // moins de 5 valeurs : quantile exact
+    for (uint8_t i = 0; i < _n; i++) s[i] = _q[i];
+    for (uint8_t i = 1; i < _n; i++)
+      for (uint8_t j = i; j > 0 && s[j - 1] > s[j]; j--) { float t = s[j]; s[j] = s[j - 1]; s[j - 1] = t; }
+    return s[(uint8_t)(_p * (_n - 1) + 0.5f)];
+  }
+
+private:
+  float _p;
+  float _q[5] = { 0 }, _pos[5] = { 0 }, _des[5] = { 0 };
+  uint32_t _n = 0;
+};
+
+// Agrégats d'un sens de course (courses complètes uniquement)
+struct CycleAgg {
+  uint32_t n = 0;
+  float meanMs = 0.0f;
+  float ewmaFastMs = 0.0f, ewmaSlowMs = 0.0f;  // tendance = rapide vs lente
+  float meanPeak = 0.0f;                       // pic moyen / vmax (0..1)
+  P2Quantile p95Ms{ 0.95f };
+
+  void add(float ms, float peak) {
+    n++;
+    meanMs += (ms - meanMs) / (float)n;
+    meanPeak += (peak - meanPeak) / (float)n;
+    if (n == 1) { ewmaFastMs = ewmaSlowMs = ms; }
+    else { ewmaFastMs += 0.3f * (ms - ewmaFastMs); ewmaSlowMs += 0.05f * (ms - ewmaSlowMs); }
+    p95Ms.add(ms);
+  }
+  // > 0 : les dernières courses sont plus lentes que la moyenne longue (usure, frottement)
+  float trendPct() const { return ewmaSlowMs > 0.0f ? 100.0f * (ewmaFastMs - ewmaSlowMs) / ewmaSlowMs : 0.0f; }
+};
+
+class CycleStats {
+public:
+  // Début d'une course (OPENING/CLOSING)
+  void begin(bool opening, long pos, unsigned long nowMs) {
+    _active = true;
+    _opening = opening;
+    _startPos = pos;
+    _startMs = nowMs;
+    _events = 0;
+  }
+  bool active() const { return _active; }
+  void addEvent(uint8_t ev) { if (_active) _events |= ev; }
+
+  // Fin de course : enregistre l'entrée et met à jour les agrégats (courses complètes seulement)
+  void end(long pos, unsigned long nowMs, float peakSps, float vmaxSps, float tempC) {
+    if (!_active) return;
+    _active = false;
+
+    CycleEntry& e = _ring[_head];
+    e.seq = ++_total;
+    e.durationMs = nowMs - _startMs;
+    e.steps = (uint32_t)labs(pos - _startPos);
+    float peak = (vmaxSps > 0.0f) ? peakSps / vmaxSps : 0.0f;
+    e.peakPermille = (uint16_t)constrain((long)(peak * 1000.0f + 0.5f), 0L, 65535L);
+    e.tempDeciC = (int16_t)constrain((long)lroundf(tempC * 10.0f), -32768L, 32767L);
+    e.opening = _opening ? 1 : 0;
+    e.events = _events;
+    _head = (uint16_t)((_head + 1) % CYCLE_RING_SIZE);
+    if (_count < CYCLE_RING_SIZE) _count++;
+
+    if (_events) _interrupted++;
+    else (_opening ? _open : _close).add((float)e.durationMs, peak);
+  }
+
+  // Accès chronologique : 0 = plus ancienne entrée conservée
+  uint16_t count() const { return _count; }
+  const CycleEntry& at(uint16_t i) const { return _ring[(_head + CYCLE_RING_SIZE - _count + i) % CYCLE_RING_SIZE]; }
+
+  const CycleAgg& agg(bool opening) const { return opening ? _open : _close; }
+  uint32_t total() const { return _total; }
+  uint32_t interrupted() const { return _interrupted; }
+
+private:
+  CycleEntry _ring[CYCLE_RING_SIZE];
+  uint16_t _head = 0, _count = 0;
+  uint32_t _total = 0, _interrupted = 0;
+  CycleAgg _open, _close;
+
+  bool _active = false, _opening = false;
+  long _startPos = 0;
+  unsigned long _startMs = 0;
+  uint8_t _events = 0;
+};
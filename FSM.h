@@ -4,9 +4,10 @@
 #include "Config.h"
 #include "WebUI.h"
 #include "CounterControl.h"
+#include "CycleStats.h"
+#include "AutoTune.h"
 #include <string.h>
 
-extern CounterControl ctrl;
 extern const long kHomingTravel;
 extern const unsigned long kHomingTimeoutMs;
 
@@ -14,9 +15,9 @@ static bool distanceRequested = false;
 static unsigned long distanceReqMs = 0;
 static float bootDistanceCm = -1.0f;
 static String distRxBuffer;
-static long measureStartPos = 0;
-static unsigned long measureLastCalibSeen = 0;
-static unsigned long measureStartMs = 0;
+
+// Dernière température lue sur la Nano (mise à jour par loop(), non bloquante)
+static float latestTempC = 0.0f;
 // -------------------- FSM --------------------
 enum class State : uint8_t {
   BOOT,
@@ -27,45 +28,188 @@ enum class State : uint8_t {
   CLOSING,
   STOPPING,
   FAULT,
-  MEASURE
+  MEASURE,
+  AUTOTUNE
 };
-static State st = State::BOOT;
 
 enum class Cmd : uint8_t { NONE,
                            OPEN,
                            CLOSE,
                            STOP,
-                           MEASURE };
-static volatile Cmd pendingCmd = Cmd::NONE;
+                           MEASURE,
+                           AUTOTUNE,
+                           SET_TURNS,   // réglages d'un lot /cmd : appliqués à leur tour, à l'arrêt
+                           SET_SPEED,
+                           SET_ACCEL };
+
+// Commande terminée (API /cmd, /done)
+struct CmdDone {
+  uint32_t id;
+  uint8_t state;            // WebUI_CmdState
+  float posTurns;
+  unsigned long elapsedMs;
+};
+
+// File : un lot /cmd complet (réglages compris). Historique par axe : un lot complet + file
+// + en attente, STOP et mouvement actif, sans écraser un résultat avant que le client ne l'ait lu.
+#define CMD_QUEUE_LEN 8
+#define CMD_DONE_RING 32
+static_assert(CMD_QUEUE_LEN >= WEBUI_MAX_BATCH_OPS, "CMD_QUEUE_LEN : un lot /cmd doit tenir dans la file");
+static_assert((CMD_QUEUE_LEN & (CMD_QUEUE_LEN - 1)) == 0, "CMD_QUEUE_LEN : puissance de 2");
+static_assert(CMD_DONE_RING >= WEBUI_MAX_BATCH_OPS + CMD_QUEUE_LEN + 3, "CMD_DONE_RING trop petit");
+static_assert((CMD_DONE_RING & (CMD_DONE_RING - 1)) == 0, "CMD_DONE_RING : puissance de 2");
+// Chaque axe doit être routable par ?axis=N et avoir ses valeurs d'affichage dans la WebUI
+static_assert(AXIS_COUNT >= 1 && AXIS_COUNT <= WEBUI_MAX_AXES, "AXIS_COUNT : 1..WEBUI_MAX_AXES (augmenter WEBUI_MAX_AXES dans WebUI.h)");
+
+// -------------------- ÉTAT PAR AXE --------------------
+// Une instance par compteur piloté ; fsmTick(ax) ne touche qu'à son axe.
+struct AxisFsm {
+  CounterControl* ctrl = nullptr;
+  uint8_t index = 0;
+
+  State st = State::BOOT;
+  State tracedSt = State::BOOT;  // dernier état marqué dans la trace moteur
+  volatile Cmd pendingCmd = Cmd::NONE;
+  float pendingVal = 0.0f;       // valeur d'un Cmd::SET_*
+
+  // Paramètres de mouvement propres à l'axe (initialisés depuis Config.h)
+  float openTurns   = kOpenTurns;
+  float vmaxSteps   = kVmaxSteps;
+  float accelSteps2 = kAccelSteps2;
+
+  // Variables de contrôle
+  unsigned long homingStartMs = 0;
+  unsigned long lastCalibSeen = 0;
+  unsigned long cycles = 0;
+  bool openedSinceLastClose = false;
+  long measureStartPos = 0;
+  unsigned long measureLastCalibSeen = 0;
+  unsigned long measureStartMs = 0;
+
+  // Historique mouvement
+  Cmd lastMotion = Cmd::CLOSE;  // dernier mouvement réellement lancé
+
+  // Suivi des commandes (API /cmd)
+  uint32_t pendingId = 0;          // id associé à pendingCmd
+  uint32_t activeId = 0;           // id du mouvement en cours
+  uint32_t stopId = 0;             // id du STOP en cours d'exécution
+  unsigned long activeStartMs = 0;
+
+  // Statistiques des courses OPENING/CLOSING (/cycles)
+  CycleStats stats;
+
+  // Recherche AUTOTUNE
+  AutoTune tuner;
+  // Profil moteur emprunté (homing, mesure, recherche) : rétabli à la sortie, STOP compris
+  bool restoreProfile = false;
+
+  // Petite file d'attente de commandes (FIFO)
+  Cmd cmdQ[CMD_QUEUE_LEN];
+  uint32_t cmdQId[CMD_QUEUE_LEN];
+  float cmdQVal[CMD_QUEUE_LEN];
+  uint8_t qHead = 0, qTail = 0, qCount = 0;
+
+  // Commandes terminées de l'axe (/done)
+  CmdDone done[CMD_DONE_RING];
+  uint8_t doneHead = 0, doneCount = 0;
+};
+
+// Définis dans le .ino (un état FSM par axe du StepScheduler)
+extern AxisFsm axes[AXIS_COUNT];
+
+static inline void fsmLog(const AxisFsm& ax, const String& msg) {
+  if (AXIS_COUNT > 1) WebUI::addLog("[A" + String(ax.index) + "]" + msg);
+  else WebUI::addLog(msg);
+}
+
+// --------- Identifiants de commandes (API /cmd) ----------
+// Chaque commande reçoit un id unique tous axes confondus ; 0 = commande interne non suivie.
+static uint32_t nextCmdId = 1;
+
+static inline uint32_t newCmdId() {
+  if (nextCmdId == 0) nextCmdId = 1;  // rebouclage : 0 reste réservé
+  return nextCmdId++;
+}
+
+static inline void recordDone(AxisFsm& ax, uint32_t id, uint8_t state, unsigned long elapsedMs) {
+  if (!id) return;
+  ax.done[ax.doneHead] = { id, state, ax.ctrl->positionTurns(), elapsedMs };
+  ax.doneHead = (uint8_t)((ax.doneHead + 1) & (CMD_DONE_RING - 1));
+  if (ax.doneCount < CMD_DONE_RING) ax.doneCount++;
+}
+
+static inline void beginActive(AxisFsm& ax, uint32_t id) {
+  ax.activeId = id;
+  ax.activeStartMs = millis();
+}
 
-// Variables de contrôle
-static unsigned long homingStartMs = 0;
-static unsigned long lastCalibSeen = 0;
-static unsigned long cycles = 0;
-static bool openedSinceLastClose = false;
+static inline void finishActive(AxisFsm& ax, uint8_t state) {
+  recordDone(ax, ax.activeId, state, millis() - ax.activeStartMs);
+  ax.activeId = 0;
+}
 
-// Historique mouvement
-static Cmd lastMotion = Cmd::CLOSE;  // dernier mouvement réellement lancé
+// Remplace la commande en attente ; celle écrasée est marquée "dropped".
+static inline void setPending(AxisFsm& ax, Cmd c, uint32_t id, float val = 0.0f) {
+  if (ax.pendingCmd != Cmd::NONE && ax.pendingId != id) recordDone(ax, ax.pendingId, CMD_DROPPED, 0);
+  ax.pendingCmd = c;
+  ax.pendingId = id;
+  ax.pendingVal = val;
+}
 
 // --------- Petite file d'attente de commandes (FIFO) ----------
-static Cmd cmdQ[4];
-static uint8_t qHead = 0, qTail = 0, qCount = 0;
-
-static inline bool qPush(Cmd c) {
-  if (qCount == 4) return false;  // file pleine -> ignorer
-  cmdQ[qTail] = c;
-  qTail = (uint8_t)((qTail + 1) & 3);
-  qCount++;
+static inline uint8_t qFree(const AxisFsm& ax) { return (uint8_t)(CMD_QUEUE_LEN - ax.qCount); }
+
+static inline bool qPush(AxisFsm& ax, Cmd c, uint32_t id = 0, float val = 0.0f) {
+  if (ax.qCount == CMD_QUEUE_LEN) return false;  // file pleine -> ignorer
+  ax.cmdQ[ax.qTail] = c;
+  ax.cmdQId[ax.qTail] = id;
+  ax.cmdQVal[ax.qTail] = val;
+  ax.qTail = (uint8_t)((ax.qTail + 1) & (CMD_QUEUE_LEN - 1));
+  ax.qCount++;
   return true;
 }
-static inline bool qPop(Cmd& out) {
-  if (!qCount) return false;
-  out = cmdQ[qHead];
-  qHead = (uint8_t)((qHead + 1) & 3);
-  qCount--;
+static inline bool qPop(AxisFsm& ax, Cmd& out, uint32_t& id, float& val) {
+  if (!ax.qCount) return false;
+  out = ax.cmdQ[ax.qHead];
+  id = ax.cmdQId[ax.qHead];
+  val = ax.cmdQVal[ax.qHead];
+  ax.qHead = (uint8_t)((ax.qHead + 1) & (CMD_QUEUE_LEN - 1));
+  ax.qCount--;
   return true;
 }
 
+// État d'une commande suivie (pour /done), tous axes confondus
+static inline bool lookupCmd(uint32_t id, WebUI_CmdInfo* out) {
+  if (!id) return false;
+  for (uint8_t a = 0; a < AXIS_COUNT; a++) {
+    const AxisFsm& ax = axes[a];
+    if (id == ax.activeId) {
+      out->state = CMD_RUNNING;
+      out->posTurns = ax.ctrl->positionTurns();
+      out->elapsedMs = millis() - ax.activeStartMs;
+      return true;
+    }
+    bool queued = (ax.pendingCmd != Cmd::NONE && id == ax.pendingId) || id == ax.stopId;
+    for (uint8_t i = 0; i < ax.qCount && !queued; i++) queued = (ax.cmdQId[(ax.qHead + i) & (CMD_QUEUE_LEN - 1)] == id);
+    if (queued) {
+      out->state = CMD_QUEUED;
+      out->posTurns = ax.ctrl->positionTurns();
+      out->elapsedMs = 0;
+      return true;
+    }
+    for (uint8_t i = 0; i < ax.doneCount; i++) {
+      const CmdDone& d = ax.done[(uint8_t)(ax.doneHead - 1 - i) & (CMD_DONE_RING - 1)];
+      if (d.id == id) {
+        out->state = d.state;
+        out->posTurns = d.posTurns;
+        out->elapsedMs = d.elapsedMs;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 // -------------------- LECTURE NANO GÉNÉRIQUE --------------------
 static inline float requestNanoValue(char cmdChar, const char* prefix, unsigned long timeoutMs = 2000) {
   while (Serial.available() > 0) Serial.read();  // purge
@@ -117,133 +261,236 @@ inline float requestNanoTemperature(unsigned long timeoutMs = 2000) {
 }
 
 // -------------------- HELPERS --------------------
-static inline void serviceButton() {
+static inline void serviceButton(AxisFsm& ax) {
+  CounterControl& ctrl = *ax.ctrl;
   if (!ctrl.readButton()) return;
 
-  WebUI::addLog(String("[DEBUG] Button: st=") + String((int)st) + ", moving=" + (ctrl.isMoving() ? "true" : "false"));
+  fsmLog(ax, String("[DEBUG] Button: st=") + String((int)ax.st) + ", moving=" + (ctrl.isMoving() ? "true" : "false"));
 
   if (ctrl.isMoving()) {
-    if (st != State::STOPPING) {
-      pendingCmd = Cmd::STOP;  // appui en mouvement -> stop
-      WebUI::addLog("[BUTTON] Stop requested");
+    if (ax.st != State::STOPPING) {
+      setPending(ax, Cmd::STOP, newCmdId());  // appui en mouvement -> stop
+      fsmLog(ax, "[BUTTON] Stop requested");
     } else {
       // appui durant STOPPING -> programmer l'inverse après l'arrêt
-      qPush((lastMotion == Cmd::OPEN) ? Cmd::CLOSE : Cmd::OPEN);
-      WebUI::addLog("[BUTTON] Queued inverse after stop");
+      qPush(ax, (ax.lastMotion == Cmd::OPEN) ? Cmd::CLOSE : Cmd::OPEN, newCmdId());
+      fsmLog(ax, "[BUTTON] Queued inverse after stop");
     }
-  } else if (st == State::IDLE) {
+  } else if (ax.st == State::IDLE) {
     // Toggle à l'arrêt: si pos==0 -> OPEN, sinon -> CLOSE
     Cmd want = (ctrl.positionSteps() == 0) ? Cmd::OPEN : Cmd::CLOSE;
-    if (pendingCmd == Cmd::NONE) pendingCmd = want;
-    else (void)qPush(want);
-    WebUI::addLog(want == Cmd::OPEN ? "[BUTTON] Open requested" : "[BUTTON] Close requested");
+    if (ax.pendingCmd == Cmd::NONE) setPending(ax, want, newCmdId());
+    else (void)qPush(ax, want, newCmdId());
+    fsmLog(ax, want == Cmd::OPEN ? "[BUTTON] Open requested" : "[BUTTON] Close requested");
   }
 }
 
-static inline void startMeasurement() {
-  measureStartPos = ctrl.positionSteps();
-  measureLastCalibSeen = ctrl.lastCalibMs();
-  measureStartMs = millis();
+// Zones de vitesse : approche lente aux deux extrémités, pleine vitesse au milieu.
+// Dépend de openTurns -> à rappeler quand la course change (/set, MEASURE).
+static inline void applySpeedZones(AxisFsm& ax) {
+  SpeedZone zones[kDefaultZoneCount];
+  ax.ctrl->setSpeedZones(zones, defaultSpeedZones(zones, ax.openTurns));
+}
+
+// Course, vitesse et accélération de l'axe -> moteur + affichage WebUI
+static inline void applyMotionParams(AxisFsm& ax) {
+  ax.ctrl->setOpenTurns(ax.openTurns);
+  ax.ctrl->setMaxSpeedSteps(ax.vmaxSteps);
+  ax.ctrl->setAccelerationSteps2(ax.accelSteps2);
+  applySpeedZones(ax);
+  WebUI::setOpenTurns(ax.openTurns, ax.index);
+  WebUI::setSpeedDisplay(ax.vmaxSteps, ax.index);
+  WebUI::setAccelDisplay(ax.accelSteps2, ax.index);
+}
+
+// Homing, mesure et recherche pilotent eux-mêmes vitesse, accélération et course : un réglage
+// changerait le profil en pleine recherche puis serait écrasé à la fin -> refusé (409).
+static inline bool settingsLocked(const AxisFsm& ax) {
+  return ax.st == State::BOOT || ax.st == State::HOMING_START || ax.st == State::HOMING_RUN
+      || ax.st == State::MEASURE || ax.st == State::AUTOTUNE;
+}
+
+// Réglage (/set, lot /cmd) : false si refusé (settingsLocked)
+static inline bool applySetting(AxisFsm& ax, Cmd what, float v) {
+  if (settingsLocked(ax)) return false;
+  if (what == Cmd::SET_TURNS)      ax.openTurns   = v;
+  else if (what == Cmd::SET_SPEED) ax.vmaxSteps   = v;
+  else                             ax.accelSteps2 = v;
+  applyMotionParams(ax);
+  return true;
+}
+
+static inline void startMeasurement(AxisFsm& ax) {
+  CounterControl& ctrl = *ax.ctrl;
+  ax.measureStartPos = ctrl.positionSteps();
+  ax.measureLastCalibSeen = ctrl.lastCalibMs();
+  ax.measureStartMs = millis();
+  ax.restoreProfile = true;
+  ctrl.enableSpeedZones(false);
   ctrl.setMaxSpeedSteps(300);
   ctrl.setAccelerationSteps2(30);
   ctrl.motor.setDirection(-1);
   ctrl.motor.move(-kHomingTravel);  // Déplacement relatif large vers butée
 }
 
-static inline void startHomingFromSensor() {
-  float d_cm = requestNanoDistance();
+static inline void startHomingFromSensor(AxisFsm& ax) {
+  CounterControl& ctrl = *ax.ctrl;
+  // Pas de requestNanoDistance() ici : bloquante jusqu'à 2 s, elle figerait les pas des
+  // autres axes en mouvement ; le homing part toujours en relatif lent.
   long bootSteps = 0;
   
   //(long)((d_cm / 25.446f) * kStepsPerRev + 90.5f); /////////// VOIR SI ON POURRAIT PAS PLUTOT DIRE : IF (!_LimitLatched && !ctrl.motor.isMoving()) set _target à une valeur quelconque et une acceleration et vitesse petite jusqu'à atteinte de la limtie.
 
-  homingStartMs = millis();
-  lastCalibSeen = ctrl.lastCalibMs();
+  ax.homingStartMs = millis();
+  ax.lastCalibSeen = ctrl.lastCalibMs();
+  ax.restoreProfile = true;
+  ctrl.enableSpeedZones(false);  // position pas encore fiable
 
   if (bootSteps > 0) {
     ctrl.motor.setCurrentPosition(bootSteps);  // position connue au-dessus du switch
     ctrl.motor.setDirection(-1);
     ctrl.motor.moveTo(0);  // aller vers 0
-    WebUI::addLog("[FSM] Distance OK, steps=" + String(bootSteps));
+    fsmLog(ax, "[FSM] Distance OK, steps=" + String(bootSteps));
   } else {
     ctrl.setMaxSpeedSteps(1200);
     ctrl.setAccelerationSteps2(40);
     ctrl.motor.setDirection(-1);
     ctrl.motor.move(-kHomingTravel);  // homing relatif lent
-    WebUI::addLog("[FSM] Distance invalid, slow homing");
+    fsmLog(ax, "[FSM] Distance invalid, slow homing");
   }
-  st = State::HOMING_RUN;
-  WebUI::addLog("[FSM] HOMING");
+  ax.st = State::HOMING_RUN;
+  fsmLog(ax, "[FSM] HOMING");
 }
 
-static inline void handleStoppingCompletion() {
-  if (!ctrl.isMoving()) {
-    st = State::IDLE;
-    if (pendingCmd == Cmd::NONE) {
-      Cmd next;
-      if (qPop(next)) pendingCmd = next;  // exécuter la commande en file, s'il y en a
+// Début / fin d'une course pour les statistiques (pic de vitesse remis à zéro à chaque course)
+static inline void beginStroke(AxisFsm& ax, bool opening) {
+  ax.ctrl->motor.resetPeak();
+  ax.stats.begin(opening, ax.ctrl->positionSteps(), millis());
+}
+
+static inline void endStroke(AxisFsm& ax) {
+  ax.stats.end(ax.ctrl->positionSteps(), millis(), ax.ctrl->motor.peakSpeed(), ax.vmaxSteps, latestTempC);
+}
+
+// Profil de l'axe (vitesse, accélération, zones, déclassement) en sortie de homing, MEASURE
+// ou AUTOTUNE, quelle que soit la sortie (fin normale, faute, STOP)
+static inline void restoreAxisProfile(AxisFsm& ax) {
+  ax.restoreProfile = false;
+  ax.ctrl->setDerateEnabled(true);
+  ax.ctrl->setMaxSpeedSteps(ax.vmaxSteps);
+  ax.ctrl->setAccelerationSteps2(ax.accelSteps2);
+  ax.ctrl->enableSpeedZones(true);
+}
+
+static inline void handleStoppingCompletion(AxisFsm& ax) {
+  if (!ax.ctrl->isMoving()) {
+    ax.st = State::IDLE;
+    if (ax.restoreProfile) restoreAxisProfile(ax);
+    endStroke(ax);  // course interrompue (no-op si aucune course en cours)
+    finishActive(ax, CMD_STOPPED);
+    recordDone(ax, ax.stopId, CMD_DONE, 0);
+    ax.stopId = 0;
+    if (ax.pendingCmd == Cmd::NONE) {
+      Cmd next; uint32_t id; float val;
+      if (qPop(ax, next, id, val)) setPending(ax, next, id, val);  // exécuter la commande en file, s'il y en a
     }
   }
 }
 
-static inline void maybePullQueueWhileIdle() {
-  if (st == State::IDLE && pendingCmd == Cmd::NONE) {
-    Cmd next;
-    if (qPop(next)) pendingCmd = next;
+static inline void maybePullQueueWhileIdle(AxisFsm& ax) {
+  if (ax.st == State::IDLE && ax.pendingCmd == Cmd::NONE) {
+    Cmd next; uint32_t id; float val;
+    if (qPop(ax, next, id, val)) setPending(ax, next, id, val);
   }
 }
 
 // -------------------- FSM CORE --------------------
-static void fsmTick() {
+static void fsmTick(AxisFsm& ax) {
+  CounterControl& ctrl = *ax.ctrl;
+
   // Bouton
-  serviceButton();
+  serviceButton(ax);
 
   // Tirer une commande éventuelle quand on est au repos (si rien de pending)
-  maybePullQueueWhileIdle();
+  maybePullQueueWhileIdle(ax);
 
   // PENDING COMMAND
-  switch (pendingCmd) {
+  switch (ax.pendingCmd) {
     case Cmd::MEASURE:
-      if (st == State::IDLE) {
-        startMeasurement();
-        st = State::MEASURE;
-        pendingCmd = Cmd::NONE;
-        WebUI::addLog("[FSM] MEASURING");
+      if (ax.st == State::IDLE) {
+        startMeasurement(ax);
+        ax.st = State::MEASURE;
+        beginActive(ax, ax.pendingId);
+        ax.pendingCmd = Cmd::NONE;
+        fsmLog(ax, "[FSM] MEASURING");
+      }
+      break;
+    case Cmd::AUTOTUNE:
+      if (ax.st == State::IDLE) {
+        ax.tuner.begin(ctrl, ax.vmaxSteps, ax.accelSteps2);
+        ax.restoreProfile = true;
+        ax.st = State::AUTOTUNE;
+        beginActive(ax, ax.pendingId);
+        ax.pendingCmd = Cmd::NONE;
+        fsmLog(ax, "[FSM] AUTOTUNE");
       }
       break;
     case Cmd::STOP:
+      // Arrêt en homing / mesure / recherche : freinage au profil en cours, profil de l'axe
+      // rétabli à l'arrêt (restoreProfile)
+      ax.stats.addEvent(CYC_EV_STOPPED);
       ctrl.stop();
-      st = State::STOPPING;
-      pendingCmd = Cmd::NONE;
-      WebUI::addLog("[FSM] STOPPING");
+      ax.st = State::STOPPING;
+      if (ax.stopId) recordDone(ax, ax.stopId, CMD_DONE, 0);  // STOP répété : le précédent est considéré exécuté
+      ax.stopId = ax.pendingId;
+      ax.pendingCmd = Cmd::NONE;
+      fsmLog(ax, "[FSM] STOPPING");
       break;
 
     case Cmd::OPEN:
-      if (st == State::IDLE) {
+      if (ax.st == State::IDLE) {
         ctrl.motor.setDirection(1);
         ctrl.open();
-        st = State::OPENING;
-        pendingCmd = Cmd::NONE;
-        lastMotion = Cmd::OPEN;
-        WebUI::addLog("[FSM] OPENING");
-      } else if (st == State::CLOSING) {
+        beginStroke(ax, true);
+        ax.st = State::OPENING;
+        beginActive(ax, ax.pendingId);
+        ax.pendingCmd = Cmd::NONE;
+        ax.lastMotion = Cmd::OPEN;
+        fsmLog(ax, "[FSM] OPENING");
+      } else if (ax.st == State::CLOSING) {
+        ax.stats.addEvent(CYC_EV_REVERSED);
         ctrl.stop();
-        st = State::STOPPING;
-        WebUI::addLog("[FSM] STOPPING");
+        ax.st = State::STOPPING;
+        fsmLog(ax, "[FSM] STOPPING");
       }
       break;
 
     case Cmd::CLOSE:
-      if (st == State::IDLE) {
+      if (ax.st == State::IDLE) {
         ctrl.motor.setDirection(-1);
         ctrl.close();
-        st = State::CLOSING;
-        pendingCmd = Cmd::NONE;
-        lastMotion = Cmd::CLOSE;
-        WebUI::addLog("[FSM] CLOSING");
-      } else if (st == State::OPENING) {
+        beginStroke(ax, false);
+        ax.st = State::CLOSING;
+        beginActive(ax, ax.pendingId);
+        ax.pendingCmd = Cmd::NONE;
+        ax.lastMotion = Cmd::CLOSE;
+        fsmLog(ax, "[FSM] CLOSING");
+      } else if (ax.st == State::OPENING) {
+        ax.stats.addEvent(CYC_EV_REVERSED);
         ctrl.stop();
-        st = State::STOPPING;
-        WebUI::addLog("[FSM] STOPPING");
+        ax.st = State::STOPPING;
+        fsmLog(ax, "[FSM] STOPPING");
+      }
+      break;
+
+    case Cmd::SET_TURNS:
+    case Cmd::SET_SPEED:
+    case Cmd::SET_ACCEL:
+      // Réglage d'un lot : entre les mouvements qui l'entourent, jamais pendant homing/mesure/recherche
+      if (ax.st == State::IDLE) {
+        applySetting(ax, ax.pendingCmd, ax.pendingVal);
+        recordDone(ax, ax.pendingId, CMD_DONE, 0);
+        ax.pendingCmd = Cmd::NONE;
       }
       break;
 
@@ -252,38 +499,37 @@ static void fsmTick() {
   }
 
   // STATES
-  switch (st) {
+  switch (ax.st) {
     case State::BOOT:
       {
         float bootDistanceCmLocal = -1;//requestNanoDistance();
         if (bootDistanceCmLocal >= 0.0f) {
-          WebUI::addLog("[FSM] Tours before close: " + String(bootDistanceCmLocal / 25.446f));
+          fsmLog(ax, "[FSM] Tours before close: " + String(bootDistanceCmLocal / 25.446f));
         } else {
-          WebUI::addLog("[FSM] Distance invalid or no reply");
+          fsmLog(ax, "[FSM] Distance invalid or no reply");
         }
-        st = State::HOMING_START;
-        WebUI::addLog("[FSM] HOMING START");
+        ax.st = State::HOMING_START;
+        fsmLog(ax, "[FSM] HOMING START");
       }
       break;
 
     case State::HOMING_START:
       {
-        startHomingFromSensor();
+        startHomingFromSensor(ax);
       }
       break;
 
     case State::HOMING_RUN:
       {
-        bool homed = (ctrl.lastCalibMs() != lastCalibSeen);
-        bool timeout = (millis() - homingStartMs) > kHomingTimeoutMs;
+        bool homed = (ctrl.lastCalibMs() != ax.lastCalibSeen);
+        bool timeout = (millis() - ax.homingStartMs) > kHomingTimeoutMs;
         if (homed || (!ctrl.isMoving() && ctrl.motor.currentPosition() == 0)) {
-          ctrl.setMaxSpeedSteps(kVmaxSteps);
-          ctrl.setAccelerationSteps2(kAccelSteps2);
-          st = State::IDLE;
-          WebUI::addLog("[FSM] IDLE");
+          restoreAxisProfile(ax);
+          ax.st = State::IDLE;
+          fsmLog(ax, "[FSM] IDLE");
         } else if (timeout) {
-          st = State::FAULT;
-          WebUI::addLog("[FSM] FAULT");
+          ax.st = State::FAULT;
+          fsmLog(ax, "[FSM] FAULT");
         }
       }
       break;
@@ -294,55 +540,103 @@ static void fsmTick() {
 
     case State::OPENING:
       if (!ctrl.isMoving()) {
-        openedSinceLastClose = true;
-        st = State::IDLE;
-        WebUI::addLog("[FSM] IDLE");
+        ax.openedSinceLastClose = true;
+        ax.st = State::IDLE;
+        endStroke(ax);
+        finishActive(ax, CMD_DONE);
+        fsmLog(ax, "[FSM] IDLE");
       }
       break;
 
     case State::CLOSING:
       if (!ctrl.isMoving()) {
-        if (openedSinceLastClose) {
-          cycles++;
-          openedSinceLastClose = false;
+        if (ax.openedSinceLastClose) {
+          ax.cycles++;
+          ax.openedSinceLastClose = false;
         }
-        st = State::IDLE;
-        WebUI::addLog("[FSM] IDLE");
+        ax.st = State::IDLE;
+        endStroke(ax);
+        finishActive(ax, CMD_DONE);
+        fsmLog(ax, "[FSM] IDLE");
       }
       break;
 
     case State::STOPPING:
-      handleStoppingCompletion();
+      handleStoppingCompletion(ax);
       break;
 
     case State::FAULT:
+      // Faute en homing / mesure : profil de l'axe rétabli une fois à l'arrêt
+      if (ax.restoreProfile && !ctrl.isMoving()) restoreAxisProfile(ax);
       // rester en faute jusqu’à STOP, puis relancer homing
-      if (pendingCmd == Cmd::STOP) {
-        pendingCmd = Cmd::NONE;
-        st = State::HOMING_START;
-        WebUI::addLog("[FSM] HOMING START");
+      if (ax.pendingCmd == Cmd::STOP) {
+        ax.pendingCmd = Cmd::NONE;
+        ax.st = State::HOMING_START;
+        fsmLog(ax, "[FSM] HOMING START");
       }
       break;
     case State::MEASURE:
       {
-        bool homed = (ctrl.lastCalibMs() != measureLastCalibSeen);
-        bool timeout = (millis() - measureStartMs) > kHomingTimeoutMs;
+        bool homed = (ctrl.lastCalibMs() != ax.measureLastCalibSeen);
+        bool timeout = (millis() - ax.measureStartMs) > kHomingTimeoutMs;
         if (homed) {
           long steps_taken = abs(ctrl.lastCalibSteps());
-          WebUI::addLog("[MEASURE] Steps taken: " + String(steps_taken));
+          fsmLog(ax, "[MEASURE] Steps taken: " + String(steps_taken));
           Serial.print("Measured steps: ");
           Serial.println(steps_taken);
-          kOpenTurns = (float)steps_taken / (float)kStepsPerRev;
-          ctrl.setOpenTurns(kOpenTurns);
-          WebUI::setOpenTurns(kOpenTurns);
-          WebUI::addLog("[MEASURE] New open turns: " + String(kOpenTurns, 2));
-          st = State::IDLE;
-          WebUI::addLog("[FSM] IDLE");
+          ax.openTurns = (float)steps_taken / (float)kStepsPerRev;
+          ctrl.setOpenTurns(ax.openTurns);
+          applySpeedZones(ax);
+          restoreAxisProfile(ax);
+          WebUI::setOpenTurns(ax.openTurns, ax.index);
+          fsmLog(ax, "[MEASURE] New open turns: " + String(ax.openTurns, 2));
+          ax.st = State::IDLE;
+          finishActive(ax, CMD_DONE);
+          fsmLog(ax, "[FSM] IDLE");
         } else if (timeout || !ctrl.isMoving()) {
-          st = State::FAULT;
-          WebUI::addLog("[FSM] FAULT");
+          ax.st = State::FAULT;
+          finishActive(ax, CMD_FAULT);
+          fsmLog(ax, "[FSM] FAULT");
         }
       }
       break;
+    case State::AUTOTUNE:
+      {
+        uint8_t ev = ax.tuner.tick(latestTempC);
+        if (ev == TUNE_STROKE_OK || ev == TUNE_STROKE_LOST) {
+          fsmLog(ax, "[TUNE] v=" + String(ax.tuner.lastSpeed() / kStepsPerRev, 2) + " tr/s a="
+                     + String(ax.tuner.lastAccel() / kStepsPerRev, 2) + " tr/s2, écart " + String(ax.tuner.lastError())
+                     + (ev == TUNE_STROKE_OK ? " pas : OK" : " pas : PERTE"));
+        } else if (ev == TUNE_DONE) {
+          ax.vmaxSteps = ax.tuner.resultSpeed();
+          ax.accelSteps2 = ax.tuner.resultAccel();
+          restoreAxisProfile(ax);
+          WebUI::setSpeedDisplay(ax.vmaxSteps, ax.index);
+          WebUI::setAccelDisplay(ax.accelSteps2, ax.index);
+          fsmLog(ax, "[TUNE] Résultat : " + String(ax.vmaxSteps, 0) + " steps/s, " + String(ax.accelSteps2, 0) + " steps/s2"
+                     + (ax.tuner.tempLimited() ? " (limité par la température)" : ""));
+          ax.st = State::IDLE;
+          finishActive(ax, CMD_DONE);
+          fsmLog(ax, "[FSM] IDLE");
+        } else if (ev == TUNE_FAILED) {
+          restoreAxisProfile(ax);
+          finishActive(ax, CMD_FAULT);
+          if (ax.tuner.lostReference()) {
+            ax.st = State::FAULT;  // fin de course introuvable : position inconnue
+            fsmLog(ax, "[FSM] FAULT");
+          } else {
+            fsmLog(ax, "[TUNE] Profil de départ non fiable, réglages inchangés");
+            ax.st = State::IDLE;
+            fsmLog(ax, "[FSM] IDLE");
+          }
+        }
+      }
+      break;
+  }
+
+  // Trace : marquer chaque transition d'état (code = State)
+  if (ax.st != ax.tracedSt) {
+    ctrl.motor.traceMark((uint8_t)ax.st);
+    ax.tracedSt = ax.st;
   }
 }
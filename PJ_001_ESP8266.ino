@@ -6,47 +6,95 @@
 #include "FSM.h"
 #include "Config.h"  // constantes par défaut (moteur & UI)
 #include "CounterControl.h"
+#include "StepScheduler.h"
 #include "WebUI.h"
 
-// -------------------- Objet moteur --------------------
-// Instance unique du contrôleur moteur.  Ne pas marquer comme `static` afin que
-// l'automate dans FSM.h puisse y accéder via une déclaration `extern`.
-CounterControl ctrl;
+// -------------------- Objets moteur --------------------
+// Le scheduler possède les axes ; un état d'automate par axe. Ne pas marquer `axes`
+// comme `static` afin que FSM.h puisse y accéder via une déclaration `extern`.
+static StepScheduler<AXIS_COUNT> sched;
+AxisFsm axes[AXIS_COUNT];
 
 // -------------------------------------------------------------------------------------
-// Mesure de température cachée (non bloquante)
-static float latestTempC = 0.0f;
+// Mesure de température cachée (non bloquante) ; latestTempC est dans FSM.h
 static unsigned long lastTempUpdateMs = 0;
 static const unsigned long TEMP_UPDATE_INTERVAL_MS = 5000UL;
 
 // -------------------- Helpers --------------------
-static inline void applyMotionParams() {
-  ctrl.setOpenTurns(kOpenTurns);
-  ctrl.setMaxSpeedSteps(kVmaxSteps);
-  ctrl.setAccelerationSteps2(kAccelSteps2);
-  WebUI::setOpenTurns(kOpenTurns);
-  WebUI::setSpeedDisplay(kVmaxSteps);
-  WebUI::setAccelDisplay(kAccelSteps2);
-}
+// Axe visé par la requête HTTP en cours (?axis=N)
+static inline AxisFsm& reqAxis() { return axes[WebUI::requestAxis()]; }
 
-static inline void issue(Cmd c) { pendingCmd = c; }
+static inline void issue(Cmd c) { AxisFsm& ax = reqAxis(); setPending(ax, c, newCmdId()); }
 
 // -------------------- WebUI Callbacks --------------------
 static void onOpen()  { issue(Cmd::OPEN);  }
 static void onClose() { issue(Cmd::CLOSE); }
 static void onStop()  { issue(Cmd::STOP);  }
 static void onMeasure() { issue(Cmd::MEASURE); }
+static void onAutotune() { issue(Cmd::AUTOTUNE); }
+
+static bool onSetTurns(float v)      { return v > 0.0f && applySetting(reqAxis(), Cmd::SET_TURNS, v); }
+static bool onSetSpeed(float v)      { return v > 0.0f && applySetting(reqAxis(), Cmd::SET_SPEED, v); }
+static bool onSetAccel(float v)      { return v > 0.0f && applySetting(reqAxis(), Cmd::SET_ACCEL, v); }
+
+// Lot /cmd : mouvements et réglages passent tous par la file de l'automate, dans l'ordre
+// du lot (un réglage s'applique à l'arrêt, entre les mouvements qui l'entourent).
+// Un STOP n'est accepté qu'en tête des mouvements (préemption). Réglages refusés comme /set
+// pendant homing, mesure ou recherche.
+static uint8_t onCmdBatch(const WebUI_Op* ops, uint8_t n, uint32_t* ids) {
+  AxisFsm& ax = reqAxis();
+  uint8_t motions = 0;
+  bool leadingStop = false;
+  for (uint8_t i = 0; i < n; i++) {
+    if (ops[i].kind == OP_STOP) {
+      if (motions) return BATCH_STOP_ORDER;
+      leadingStop = true;
+    }
+    if (ops[i].kind <= OP_AUTOTUNE) motions++;
+    else if (settingsLocked(ax)) return BATCH_SETTINGS_LOCKED;
+  }
+  if ((uint8_t)(n - (leadingStop ? 1 : 0)) > qFree(ax)) return BATCH_QUEUE_FULL;
+
+  for (uint8_t i = 0; i < n; i++) {
+    ids[i] = newCmdId();
+    switch (ops[i].kind) {
+      case OP_STOP:    setPending(ax, Cmd::STOP, ids[i]); break;
+      case OP_OPEN:    qPush(ax, Cmd::OPEN, ids[i]); break;
+      case OP_CLOSE:   qPush(ax, Cmd::CLOSE, ids[i]); break;
+      case OP_MEASURE: qPush(ax, Cmd::MEASURE, ids[i]); break;
+      case OP_AUTOTUNE: qPush(ax, Cmd::AUTOTUNE, ids[i]); break;
+      case OP_TURNS:   qPush(ax, Cmd::SET_TURNS, ids[i], ops[i].value); break;
+      case OP_SPEED:   qPush(ax, Cmd::SET_SPEED, ids[i], ops[i].value); break;
+      case OP_ACCEL:   qPush(ax, Cmd::SET_ACCEL, ids[i], ops[i].value); break;
+    }
+  }
+  return BATCH_OK;
+}
 
-static void onSetTurns(float v)      { if (v > 0.0f) { kOpenTurns   = v; applyMotionParams(); } }
-static void onSetSpeed(float v)      { if (v > 0.0f) { kVmaxSteps   = v; applyMotionParams(); } }
-static void onSetAccel(float v)      { if (v > 0.0f) { kAccelSteps2 = v; applyMotionParams(); } }
+static bool onGetCmd(uint32_t id, WebUI_CmdInfo* out) { return lookupCmd(id, out); }
+
+static void onTraceEnable(bool on, bool once) { reqAxis().ctrl->motor.traceEnable(on, once); }
+static void getTraceInfo(WebUI_TraceInfo* out) {
+  const StepperKiss& m = reqAxis().ctrl->motor;
+  out->enabled = m.traceEnabled();
+  out->once = m.traceOnce();
+  out->count = m.traceCount();
+  out->dropped = m.traceDropped();
+  out->stepsPerRev = (uint32_t)kStepsPerRev;
+}
+static uint16_t onTraceRead(uint16_t from, uint32_t* dst, uint16_t n) { return reqAxis().ctrl->motor.traceRead(from, dst, n); }
+
+static const CycleStats* getCycles() { return &reqAxis().stats; }
 
 static void getStatus(void* out_) {
   auto* out = reinterpret_cast<WebUI_Status*>(out_);
+  const AxisFsm& ax = reqAxis();
   out->tempC = latestTempC;                             // non bloquant
-  out->lastCalibMs = ctrl.lastCalibMs();
-  out->posTurns = ctrl.positionTurns();
-  out->cycles = cycles;
+  out->lastCalibMs = ax.ctrl->lastCalibMs();
+  out->posTurns = ax.ctrl->positionTurns();
+  out->cycles = ax.cycles;
+  out->deratePct = (int)lroundf(ax.ctrl->derateFactor() * 100.0f);
+  out->driverOn = ax.ctrl->driverEnabled();
   out->ip = WiFi.localIP();
   out->uptimeSec = millis() / 1000UL;
   uint32_t freeH = ESP.getFreeHeap();
@@ -61,38 +109,67 @@ void setup() {
   Serial.begin(115200);
   delay(100);
 /**/
-  // Moteur + fins de course
-  ctrl.begin(
-    /*STEP_PIN D7*/13, /*DIR_PIN D6*/12, /*ENA_PIN D5*/14, /*ENA_ACTIVE_LOW*/true,
-    /*LIMIT_BOTTOM D1*/5, /*limitActiveLow=*/true,
-    kStepsPerRev, kOpenTurns);
-  applyMotionParams();
+  // Moteurs + fins de course (le bouton physique pilote l'axe 0)
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    CounterControl& c = sched.axis(i);
+    c.begin(kAxisPins[i].step, kAxisPins[i].dir, kAxisPins[i].ena, ENA_ACTIVE_LOW,
+            kAxisPins[i].limit, /*limitActiveLow=*/true,
+            kStepsPerRev, axes[i].openTurns);
+    if (i == 0) c.attachButton(BUTTON_PIN);
+    c.setDriverIdle(DRIVER_IDLE_OFF_MS, DRIVER_SETTLE_MS);
+    c.setDerateCurve(kDerateCurve, kDerateCurveLen);
+    axes[i].ctrl = &c;
+    axes[i].index = i;
+    applyMotionParams(axes[i]);
+  }
 
   // Réseau & UI
+  WebUI::setAxisCount(AXIS_COUNT);
   WebUI::setCallbacks(onOpen, onClose, onStop, onMeasure, onSetTurns, onSetSpeed, onSetAccel, getStatus);
+  WebUI::setCmdCallbacks(onCmdBatch, onGetCmd);
+  WebUI::setTraceCallbacks(onTraceEnable, getTraceInfo, onTraceRead);
+  WebUI::setCyclesCallback(getCycles);
+  WebUI::setAutotuneCallback(onAutotune);
   WebUI::begin(WIFI_SSID, WIFI_PWD);
   WebUI::addLog("[FSM] Boot");
 }
 
 void loop() {
   // ---------------- priorité aux pas moteur ----------------
-  ctrl.poll();                    // limites + run() stepper
+  sched.poll();                   // limites + run() des axes échus (échéance la plus ancienne d'abord)
+  const bool moving = sched.anyMoving();
 
-  // ---------------- UI seulement si à l'arrêt ----------------
-  if (!ctrl.isMoving()) {
+  // ---------------- UI : à l'arrêt ; en mouvement, par tranches si WEBUI_SERVE_WHILE_MOVING ----------------
+  static unsigned long lastMovingUiMs = 0;
+  WebUI::setMotionBusy(moving);
+  if (!moving) {
     WebUI::loop();                // HTTP UI
+  } else if (WEBUI_SERVE_WHILE_MOVING && millis() - lastMovingUiMs >= WEBUI_MOVING_POLL_MS) {
+    lastMovingUiMs = millis();
+    WebUI::loop();                // un client au plus : /stop, commandes, /status, /done
   }
 
-  // ---------------- tick de l'automate ----------------
-  fsmTick();
+  // ---------------- tick de l'automate (un par axe) ----------------
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) fsmTick(axes[i]);
 
   // Laisser respirer le Wi-Fi si ça bouge
-  if (ctrl.isMoving()) yield();
+  if (moving) yield();
 
   // Température non bloquante (à l'arrêt seulement)
-  if ((millis() - lastTempUpdateMs) >= TEMP_UPDATE_INTERVAL_MS && !ctrl.isMoving()) {
+  if ((millis() - lastTempUpdateMs) >= TEMP_UPDATE_INTERVAL_MS && !sched.anyMoving()) {
     float t = requestNanoTemperature();
-    if (t >= 0.0f) latestTempC = t;
+    if (t >= 0.0f) {
+      latestTempC = t;
+      // Déclassement thermique de chaque axe (la sonde Nano est commune)
+      for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+        CounterControl& c = sched.axis(i);
+        float before = c.derateFactor();
+        c.setTemperature(t);
+        c.pollInputs();  // à l'arrêt : applique le nouveau facteur tout de suite
+        if (fabsf(c.derateFactor() - before) >= 0.05f)
+          fsmLog(axes[i], "[THERM] " + String(t, 1) + " C -> vitesse x" + String(c.derateFactor(), 2));
+      }
+    }
     lastTempUpdateMs = millis();
   }
 }
@@ -0,0 +1,53 @@
+// Classe StepScheduler : plusieurs compteurs (CounterControl) sur un seul ESP8266.
+// - Possède les N axes ; accès par axis(i).
+// - poll() : entrées (fin de course, bouton) de tous les axes, puis run() des seuls axes
+//   dont le prochain pas est échu, l'échéance la plus ancienne d'abord.
+// - Un axe dont le pas n'est pas échu n'est pas intégré : pas de calcul flottant (soft-float
+//   sur ESP8266) qui retarderait le pas d'un autre axe.
+
+#pragma once
+#include <Arduino.h>
+#include "CounterControl.h"
+
+template <uint8_t N>
+class StepScheduler {
+public:
+  CounterControl& axis(uint8_t i) { return _axes[i]; }
+  const CounterControl& axis(uint8_t i) const { return _axes[i]; }
+  uint8_t count() const { return N; }
+
+  bool anyMoving() const {
+    for (uint8_t i = 0; i < N; i++) if (_axes[i].isMoving()) return true;
+    return false;
+  }
+
+  // Retourne le nombre de pas émis pendant ce passage
+  uint8_t poll() {
+    const unsigned long now = micros();
+
+    // Tableau d'échéances trié par retard décroissant (tri par insertion, N est petit).
+    // Un axe non planifié (échéance 0) passe après les pas réellement échus.
+    uint8_t order[N];
+    long late[N];
+    uint8_t due = 0;
+    for (uint8_t i = 0; i < N; i++) {
+      CounterControl& c = _axes[i];
+      c.pollInputs();
+      if (!c.stepDue(now)) continue;
+      unsigned long next = c.motor.nextStepUs();
+      long l = next ? (long)(now - next) : -1;
+      uint8_t k = due++;
+      while (k > 0 && late[k - 1] < l) { late[k] = late[k - 1]; order[k] = order[k - 1]; k--; }
+      late[k] = l;
+      order[k] = i;
+    }
+
+    uint8_t steps = 0;
+    for (uint8_t k = 0; k < due; k++)
+      if (_axes[order[k]].motor.run()) steps++;
+    return steps;
+  }
+
+private:
+  CounterControl _axes[N];
+};
@@ -37,6 +37,29 @@
   #define KISS_MAX_DT_S 0.05f  // 50 ms
 #endif
 
+// Nombre max de zones de vitesse dépendantes de la position
+#ifndef KISS_MAX_ZONES
+  #define KISS_MAX_ZONES 4
+#endif
+
+// Enregistreur d'événements : profondeur de l'anneau (0 = désactivé, aucun coût)
+// Chaque événement = 1 mot 32 bits (voir KISS_TR_*), mémoire statique dans l'objet.
+#ifndef KISS_TRACE_DEPTH
+  #define KISS_TRACE_DEPTH 0
+#endif
+
+// Format d'un événement de trace (32 bits)
+//  [23:0]  delta µs depuis l'événement précédent (saturé)
+//  [31:28] type : 0 = pas, 1 = marque (transition FSM)
+//  pas    : [27] sens (1 = +), [25:24] phase (0 accel, 1 croisière, 2 décel)
+//  marque : [27:24] code (ex. State du FSM)
+#define KISS_TR_DT_MASK   0x00FFFFFFUL
+#define KISS_TR_MARK      (1UL << 28)
+#define KISS_TR_DIR_POS   (1UL << 27)
+#define KISS_TR_PH_ACCEL  0u
+#define KISS_TR_PH_CRUISE 1u
+#define KISS_TR_PH_DECEL  2u
+
 // Pour les écritures GPIO rapides sur ESP8266 (GPOS/GPOC)
 #if defined(ARDUINO_ARCH_ESP8266)
   extern "C" {
@@ -44,6 +67,12 @@
   }
 #endif
 
+// Zone de vitesse en pas : entre from et to (inclus), |vitesse| <= vmax
+struct KissZone {
+  long from, to;
+  float vmax;  // steps/s
+};
+
 // StepperKiss — Version anti-stutter pour ESP8266
 // - Planificateur à micros(): 1 seul pas max par run()
 // - Pas de "rafales" même si loop() prend du retard
@@ -78,6 +107,18 @@ public:
   void setMaxSpeed(float stepsPerSec)      { if (stepsPerSec < 0) stepsPerSec = -stepsPerSec; _maxSpeed = stepsPerSec < 1.0f ? 1.0f : stepsPerSec; }
   void setAcceleration(float stepsPerSec2) { if (stepsPerSec2 < 0) stepsPerSec2 = -stepsPerSec2; _accel = stepsPerSec2 < 1.0f ? 1.0f : stepsPerSec2; }
 
+  // Zones de vitesse (copiées). Le planificateur freine à l'avance pour entrer dans
+  // une zone plus lente à sa vitesse, sans s'arrêter à la frontière.
+  void setZones(const KissZone* zones, uint8_t n) {
+    if (n > KISS_MAX_ZONES) n = KISS_MAX_ZONES;
+    for (uint8_t i = 0; i < n; i++) {
+      _zones[i] = zones[i];
+      if (_zones[i].to < _zones[i].from) { long t = _zones[i].to; _zones[i].to = _zones[i].from; _zones[i].from = t; }
+      if (_zones[i].vmax < 1.0f) _zones[i].vmax = 1.0f;
+    }
+    _zoneCount = n;
+  }
+
   //Gestion de la pin ENABLE
   void enable(bool on) {
     if (_enaPin < 0) return;
@@ -104,6 +145,13 @@ public:
   long currentPosition() const { return _position; }
   long targetPosition()  const { return _target; }
   float speed()          const { return _speed; }
+  int direction()        const { return _moveDir; }
+  // Échéance du prochain pas (0 = non planifié) et intervalle courant, pour StepScheduler
+  unsigned long nextStepUs()     const { return _nextStepUs; }
+  unsigned long stepIntervalUs() const { return _stepIntervalUs; }
+  // Vitesse max atteinte (|pas/s|) depuis resetPeak(), pour les statistiques de course
+  float peakSpeed() const { return _peakSpeed; }
+  void resetPeak()        { _peakSpeed = 0.0f; }
 
   void stop() {
     // place une cible pour s'arrêter en douceur
@@ -127,8 +175,9 @@ public:
     // Distance restante à parcourir en nombre de pas (stepsRemaining).
     long stepsRemaining = llabs(_target - _position);
 
-    // Si proche de l'arrêt et cible atteinte -> repos (NE PAS rafraîchir _lastUpdateUs)
-    if (stepsRemaining == 0 && fabsf(_speed) < 1e-3f) {
+    // Cible atteinte -> repos (NE PAS rafraîchir _lastUpdateUs). Plus aucun pas n'est émis :
+    // garder une vitesse résiduelle ferait osciller l'intégration autour de 0 indéfiniment.
+    if (stepsRemaining == 0) {
       _speed = 0.0f;
       _nextStepUs = 0;
       return false;
@@ -140,21 +189,38 @@ public:
     // Evite grande accélération après longue inactivité
     if (dt > KISS_MAX_DT_S) dt = KISS_MAX_DT_S;
 
+    // Zones : plafond dans la zone courante, et freinage anticipé si une zone plus lente
+    // est devant (dans le sens du mouvement, avant la cible) : v² <= vz² + 2·a·(d-1),
+    // pour que le pas qui entre dans la zone soit déjà émis à vz.
+    int dir = _moveDir;
+    float vCap = _maxSpeed;
+    bool zoneDecel = false;
+    for (uint8_t i = 0; i < _zoneCount; i++) {
+      const KissZone& z = _zones[i];
+      long d;
+      if (_position >= z.from && _position <= z.to) d = 0;
+      else if (dir > 0 && z.from > _position) d = z.from - _position;
+      else if (dir < 0 && z.to < _position)   d = _position - z.to;
+      else continue;
+      if (d == 0) { if (z.vmax < vCap) vCap = z.vmax; }
+      else if (d <= stepsRemaining && _speed * _speed > z.vmax * z.vmax + 2.0f * _accel * (float)(d - 1)) zoneDecel = true;
+    }
+
     // Choisir l'accélération en fonction de la phase et de la direction demandée
     float stepsToStop = (_speed * _speed) / (2.0f * _accel);
-    bool decelPhase = (stepsToStop >= (float)stepsRemaining);
-    int dir = _moveDir;
+    bool decelPhase = (stepsToStop >= (float)stepsRemaining) || zoneDecel;
     float a = decelPhase
                 ? -((_speed >= 0.0f) ? 1.0f : -1.0f) * _accel
                 : dir * _accel;
 
     // Intégration vitesse + clamp
     _speed += a * dt;
-    if (_speed >  _maxSpeed) _speed =  _maxSpeed;
-    if (_speed < -_maxSpeed) _speed = -_maxSpeed;
+    if (_speed >  vCap) _speed =  vCap;
+    if (_speed < -vCap) _speed = -vCap;
 
     // Intervalle souhaité (us) en fonction de la vitesse instantanée
     float sps = fabsf(_speed);
+    if (sps > _peakSpeed) _peakSpeed = sps;
     if (sps < KISS_MIN_START_SPS) sps = KISS_MIN_START_SPS;  // amorçage doux
 
     unsigned long stepInterval = (unsigned long)(1000000.0f / sps);
@@ -170,6 +236,13 @@ public:
       int stepDir = _moveDir; // le sens est dicté par le FSM
       pulseStep(stepDir);
       _position += stepDir;
+#if KISS_TRACE_DEPTH > 0
+      if (_traceOn) {
+        uint32_t phase = decelPhase ? KISS_TR_PH_DECEL
+                       : (fabsf(_speed) >= vCap ? KISS_TR_PH_CRUISE : KISS_TR_PH_ACCEL);
+        traceWrite(now, (stepDir > 0 ? KISS_TR_DIR_POS : 0UL) | (phase << 24));
+      }
+#endif
 
       // Replanifie le prochain pas à partir de "maintenant"
       _nextStepUs = now + _stepIntervalUs;
@@ -179,7 +252,94 @@ public:
     return false;
   }
 
+  // ---- Trace des pas (KISS_TRACE_DEPTH > 0) ----
+  // Démarre (vide l'anneau) ou arrête l'enregistrement.
+  // once : arrêt quand l'anneau est plein (garde le début d'une course) ; sinon les
+  // événements les plus anciens sont écrasés (garde la fin).
+  void traceEnable(bool on, bool once = false) {
+#if KISS_TRACE_DEPTH > 0
+    if (on && !_traceOn) { _traceHead = 0; _traceCount = 0; _traceTotal = 0; _traceLastUs = micros(); }
+    _traceOn = on;
+    _traceOnce = once;
+#else
+    (void)on; (void)once;
+#endif
+  }
+  bool traceEnabled() const {
+#if KISS_TRACE_DEPTH > 0
+    return _traceOn;
+#else
+    return false;
+#endif
+  }
+  bool traceOnce() const {
+#if KISS_TRACE_DEPTH > 0
+    return _traceOnce;
+#else
+    return false;
+#endif
+  }
+  // Marque un événement externe (ex. transition FSM), code sur 4 bits.
+  void traceMark(uint8_t code) {
+#if KISS_TRACE_DEPTH > 0
+    if (_traceOn) traceWrite(micros(), KISS_TR_MARK | ((uint32_t)(code & 0x0F) << 24));
+#else
+    (void)code;
+#endif
+  }
+  // Nombre d'événements disponibles / écrasés depuis traceEnable(true)
+  uint16_t traceCount() const {
+#if KISS_TRACE_DEPTH > 0
+    return _traceCount;
+#else
+    return 0;
+#endif
+  }
+  uint32_t traceDropped() const {
+#if KISS_TRACE_DEPTH > 0
+    return _traceTotal - _traceCount;
+#else
+    return 0;
+#endif
+  }
+  // Copie jusqu'à n événements à partir de l'index chronologique "from" ; retourne le nombre copié.
+  uint16_t traceRead(uint16_t from, uint32_t* dst, uint16_t n) const {
+#if KISS_TRACE_DEPTH > 0
+    if (from >= _traceCount) return 0;
+    if (n > _traceCount - from) n = _traceCount - from;
+    uint16_t idx = (uint16_t)((_traceHead + KISS_TRACE_DEPTH - _traceCount + from) % KISS_TRACE_DEPTH);
+    for (uint16_t i = 0; i < n; i++) {
+      dst[i] = _trace[idx];
+      if (++idx == KISS_TRACE_DEPTH) idx = 0;
+    }
+    return n;
+#else
+    (void)from; (void)dst; (void)n;
+    return 0;
+#endif
+  }
+
 private:
+#if KISS_TRACE_DEPTH > 0
+  // Écriture dans l'anneau : pas d'allocation, O(1)
+  inline void traceWrite(unsigned long now, uint32_t bits) {
+    if (_traceOnce && _traceCount == KISS_TRACE_DEPTH) { _traceOn = false; return; }
+    unsigned long dt = now - _traceLastUs;
+    if (dt > KISS_TR_DT_MASK) dt = KISS_TR_DT_MASK;
+    _trace[_traceHead] = bits | (uint32_t)dt;
+    if (++_traceHead == KISS_TRACE_DEPTH) _traceHead = 0;
+    if (_traceCount < KISS_TRACE_DEPTH) _traceCount++;
+    _traceTotal++;
+    _traceLastUs = now;
+  }
+
+  uint32_t _trace[KISS_TRACE_DEPTH];
+  uint16_t _traceHead = 0, _traceCount = 0;
+  uint32_t _traceTotal = 0;
+  unsigned long _traceLastUs = 0;
+  bool _traceOn = false, _traceOnce = false;
+#endif
+
   // I/O rapides facultatives (ESP8266)
   inline void writeDirFast(bool high) {
   #if defined(ARDUINO_ARCH_ESP8266)
@@ -214,6 +374,10 @@ private:
   float _maxSpeed = 2000.0f;   // steps/s
   float _accel    = 2000.0f;   // steps/s^2
   float _speed    = 0.0f;      // steps/s
+  float _peakSpeed = 0.0f;     // steps/s
+
+  KissZone _zones[KISS_MAX_ZONES];
+  uint8_t  _zoneCount = 0;
 
   unsigned long _lastUpdateUs = 0;
   unsigned long _nextStepUs   = 0;
@@ -8,8 +8,45 @@ namespace {
   static VoidCb cbOpen=nullptr, cbClose=nullptr, cbStop=nullptr, cbMeasure = nullptr;
   static SetFloatCb cbSetTurns=nullptr, cbSetSpeed=nullptr, cbSetAccel=nullptr;
   static GetStatusCb cbGetStatus=nullptr;
+  static CmdBatchCb cbBatch=nullptr;
+  static GetCmdCb cbGetCmd=nullptr;
+  static TraceEnableCb cbTraceEnable=nullptr;
+  static TraceInfoCb cbTraceInfo=nullptr;
+  static TraceReadCb cbTraceRead=nullptr;
+  static GetCyclesCb cbGetCycles=nullptr;
+  static VoidCb cbAutotune=nullptr;
 
-  static float openTurnsDisplay=10.0f, speedDisplay=50000.0f, accelDisplay=1500.0f;
+  static float openTurnsDisplay[WEBUI_MAX_AXES], speedDisplay[WEBUI_MAX_AXES], accelDisplay[WEBUI_MAX_AXES];
+  static uint8_t axisCount = 1;
+
+  static bool motionBusy = false;
+
+  static void sendJsonError(int code, const char* msg) { server.send(code, "application/json", String("{\"error\":\"") + msg + "\"}"); }
+
+  // Axe visé : ?axis=N (0 par défaut), validé par axisOk() en tête de chaque handler d'axe
+  static uint8_t currentAxis() {
+    return server.hasArg("axis") ? (uint8_t)server.arg("axis").toInt() : 0;
+  }
+
+  // ?axis= présent : entier décimal < nombre d'axes, sinon 400 (jamais de repli silencieux sur l'axe 0)
+  static bool axisOk() {
+    if (!server.hasArg("axis")) return true;
+    String a = server.arg("axis");
+    bool digits = a.length() > 0 && a.length() <= 3;
+    for (unsigned int i = 0; i < a.length() && digits; i++) digits = (a[i] >= '0' && a[i] <= '9');
+    if (digits && a.toInt() < axisCount) return true;
+    sendJsonError(400, "axis invalide");
+    return false;
+  }
+
+  // Pendant un mouvement, les réponses lourdes (page, logs, historiques) sont refusées :
+  // la tranche HTTP reste courte pour ne pas retarder les pas.
+  static bool refuseWhileMoving() {
+    if (!motionBusy) return false;
+    server.sendHeader("Retry-After", "1");
+    server.send(503, "text/plain", "Occupé : mouvement en cours");
+    return true;
+  }
 
   String logs; static uint32_t logsVer=0;
   static void pushLog(const String& s){ logs += s + "\n"; if (logs.length()>2000) logs.remove(0, logs.length()-2000); logsVer++; }
@@ -29,18 +66,27 @@ namespace {
         "<input type='submit' value='Se connecter'></form></body></html>");
       return;
     }
+    if (!axisOk() || refuseWhileMoving()) return;
+    const uint8_t ax = currentAxis();
+    const String axq = "?axis=" + String(ax);
     WebUI_Status st{}; if (cbGetStatus) cbGetStatus(&st);
     String page = "<html><head><meta charset='utf-8'></head><body>";
     page += "<h1>Contrôle moteur</h1>";
+    if (axisCount > 1) {
+      page += "<p>Axe : ";
+      for (uint8_t i = 0; i < axisCount; i++) page += (i == ax) ? "<b>" + String(i) + "</b> " : "<a href='/?axis=" + String(i) + "'>" + String(i) + "</a> ";
+      page += "</p>";
+    }
     page += "<p>Paramètres actuels :</p><form id='frmParams'>";
-    page += "Tours: <input type='number' step='0.1' name='turns' value='"+String(openTurnsDisplay,2)+"'><br>";
-    page += "Vitesse (steps/s): <input type='number' step='1' name='speed' value='"+String(speedDisplay,0)+"'><br>";
-    page += "Accélération (steps^2/s): <input type='number' step='1' name='accel' value='"+String(accelDisplay,0)+"'><br>";
+    page += "Tours: <input type='number' step='0.1' name='turns' value='"+String(openTurnsDisplay[ax],2)+"'><br>";
+    page += "Vitesse (steps/s): <input type='number' step='1' name='speed' value='"+String(speedDisplay[ax],0)+"'><br>";
+    page += "Accélération (steps^2/s): <input type='number' step='1' name='accel' value='"+String(accelDisplay[ax],0)+"'><br>";
     page += "<button type='submit' id='saveParams'>Mettre à jour</button></form>";
-    page += "<button onclick=\"fetch('/open')\">Ouvrir</button> ";
-    page += "<button onclick=\"fetch('/close')\">Fermer</button> ";
-    page += "<button onclick=\"fetch('/stop')\">Stop</button> ";
-    page += "<button onclick=\"fetch('/measure')\">Measure</button> ";
+    page += "<button onclick=\"fetch('/open"+axq+"')\">Ouvrir</button> ";
+    page += "<button onclick=\"fetch('/close"+axq+"')\">Fermer</button> ";
+    page += "<button onclick=\"fetch('/stop"+axq+"')\">Stop</button> ";
+    page += "<button onclick=\"fetch('/measure"+axq+"')\">Measure</button> ";
+    page += "<button onclick=\"fetch('/autotune"+axq+"')\">Autotune</button> ";
     page += "<button type='button' id='btnRefresh'>Refresh</button>";
     page += "<p>Cycles complétés : <span id='cycles'>" + String(st.cycles) + "</span></p>";
     page += "<h2>Informations système</h2>";
@@ -49,8 +95,9 @@ namespace {
     page += "<tr><th>Température</th><td><span id='temp'>" + String(st.tempC,2) + " &deg;C</span></td></tr>";
     page += "<tr><th>Dernière calibration</th><td><span id='calib'>" + String((millis()-st.lastCalibMs)/1000) + " s</span></td></tr>";
     page += "<tr><th>Position</th><td><span id='pos'>" + String(st.posTurns,2) + " tours</span></td></tr>";
-    page += "<tr><th>Vitesse</th><td><span id='speed'>" + String(speedDisplay,0) + " steps/s</span></td></tr>";
-    page += "<tr><th>Accélération</th><td><span id='accel'>" + String(accelDisplay,0) + " steps^2/s</span></td></tr>";
+    page += "<tr><th>Vitesse</th><td><span id='speed'>" + String(speedDisplay[ax],0) + " steps/s</span></td></tr>";
+    page += "<tr><th>Accélération</th><td><span id='accel'>" + String(accelDisplay[ax],0) + " steps^2/s</span></td></tr>";
+    page += "<tr><th>Driver</th><td><span id='drv'>" + String(st.driverOn ? "actif" : "coupé (repos)") + ", vitesse " + String(st.deratePct) + " %</span></td></tr>";
     page += "</tbody></table>";
     page += "<h2>Logs</h2><pre id='log'></pre>";
     page += "<h2>Statistiques système</h2><ul>";
@@ -61,19 +108,20 @@ namespace {
     page += "<li>IP locale: " + st.ip.toString() + "</li>";
     page += "</ul>";
     page += "<script>";
-    page += "let statusTag=null, logsTag=null;";
-    page += "function pollStatus(force){ const url='/status'+(force?('?t='+Date.now()):''); const opt= force? {} : (statusTag? {headers:{'If-None-Match':statusTag}}:{});";
-    page += "fetch(url,opt).then(r=>{ if(r.status===304) return null; statusTag=r.headers.get('ETag')||statusTag; return r.json(); })";
+    page += "let statusTag=null, logsTag=null; const AX='" + axq + "';";
+    page += "function pollStatus(force){ const url='/status'+AX+(force?('&t='+Date.now()):''); const opt= force? {} : (statusTag? {headers:{'If-None-Match':statusTag}}:{});";
+    page += "fetch(url,opt).then(r=>{ if(r.status===304) return null; if(!r.ok) throw 0; statusTag=r.headers.get('ETag')||statusTag; return r.json(); })";
     page += ".then(st=>{ if(!st) return; document.getElementById('temp').innerText=st.temp.toFixed(2)+' \\u00B0C';";
     page += "document.getElementById('calib').innerText=st.lastCalib+' s'; document.getElementById('pos').innerText=st.pos.toFixed(2)+' tours';";
     page += "const c=document.getElementById('cycles'); if(c) c.innerText=st.cycles; const sp=document.getElementById('speed'); if(sp) sp.innerText=Math.round(st.speed)+' steps/s';";
     page += "const ac=document.getElementById('accel'); if(ac) ac.innerText=Math.round(st.accel)+' steps^2/s';";
+    page += "const dv=document.getElementById('drv'); if(dv) dv.innerText=(st.driver?'actif':'coupé (repos)')+', vitesse '+st.derate+' %';";
     page += "}).catch(()=>{}).finally(()=>setTimeout(()=>pollStatus(false),5000)); }";
     page += "function pollLogs(force){ const url='/logs'+(force?('?t='+Date.now()):''); const opt= force? {} : (logsTag? {headers:{'If-None-Match':logsTag}}:{});";
-    page += "fetch(url,opt).then(r=>{ if(r.status===304) return null; logsTag=r.headers.get('ETag')||logsTag; return r.text(); })";
+    page += "fetch(url,opt).then(r=>{ if(r.status===304) return null; if(!r.ok) throw 0; logsTag=r.headers.get('ETag')||logsTag; return r.text(); })";
     page += ".then(t=>{ if(t!=null) document.getElementById('log').innerText=t; }).catch(()=>{}).finally(()=>setTimeout(()=>pollLogs(false),3000)); }";
     page += "function saveParams(){ const f=document.getElementById('frmParams'); const q=new URLSearchParams(new FormData(f)).toString();";
-    page += "fetch('/set?'+q).then(r=>{ if(!r.ok) throw 0; return r.json(); }).then(()=>{ pollStatus(true); pollLogs(true); }).catch(()=>{}); }";
+    page += "fetch('/set'+AX+'&'+q).then(r=>{ if(!r.ok) throw 0; return r.json(); }).then(()=>{ pollStatus(true); pollLogs(true); }).catch(()=>{}); }";
     page += "function forceRefresh(){ statusTag=null; logsTag=null; pollStatus(true); pollLogs(true); }";
     page += "document.addEventListener('DOMContentLoaded',()=>{ document.getElementById('frmParams').addEventListener('submit',(e)=>{e.preventDefault();saveParams();});";
     page += "const b=document.getElementById('btnRefresh'); if(b) b.addEventListener('click', forceRefresh); pollStatus(true); pollLogs(true); });";
@@ -82,39 +130,216 @@ namespace {
     server.send(200, "text/html", page);
   }
 
-  void handleOpen()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (cbOpen)  cbOpen();  pushLog("[CMD] Ouverture"); server.send(200,"text/plain","OPEN"); }
-  void handleClose() { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (cbClose) cbClose(); pushLog("[CMD] Fermeture");  server.send(200,"text/plain","CLOSE"); }
-  void handleStop()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (cbStop)  cbStop();  pushLog("[ESTOP] Commande d'arrêt reçue"); server.send(200,"text/plain","STOP"); }
-  void handleMeasure()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (cbMeasure)  cbMeasure();  pushLog("[CMD] Commande de mesure reçue"); server.send(200,"text/plain","MEASURE"); }
+  void handleOpen()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (!axisOk()) return; if (cbOpen)  cbOpen();  pushLog("[CMD] Ouverture"); server.send(200,"text/plain","OPEN"); }
+  void handleClose() { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (!axisOk()) return; if (cbClose) cbClose(); pushLog("[CMD] Fermeture");  server.send(200,"text/plain","CLOSE"); }
+  void handleStop()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (!axisOk()) return; if (cbStop)  cbStop();  pushLog("[ESTOP] Commande d'arrêt reçue"); server.send(200,"text/plain","STOP"); }
+  void handleAutotune() { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (!axisOk()) return; if (cbAutotune) cbAutotune(); pushLog("[CMD] Recherche vitesse/accélération demandée"); server.send(200,"text/plain","AUTOTUNE"); }
+  void handleMeasure()  { if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; } if (!axisOk()) return; if (cbMeasure)  cbMeasure();  pushLog("[CMD] Commande de mesure reçue"); server.send(200,"text/plain","MEASURE"); }
 
   void handleSet() {
     if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; }
-    bool changed = false;
-    if (server.hasArg("turns")) { float v = server.arg("turns").toFloat(); if (v > 0.0f) { openTurnsDisplay = v; if (cbSetTurns) cbSetTurns(v); changed = true; } }
-    if (server.hasArg("speed")) { float v = server.arg("speed").toFloat(); if (v > 0.0f) { speedDisplay     = v; if (cbSetSpeed) cbSetSpeed(v); changed = true; } }
-    if (server.hasArg("accel")) { float v = server.arg("accel").toFloat(); if (v > 0.0f) { accelDisplay     = v; if (cbSetAccel) cbSetAccel(v); changed = true; } }
-    String json = "{" "\"turns\":" + String(openTurnsDisplay,2) + "," "\"speed\":" + String(speedDisplay,0) + "," "\"accel\":" + String(accelDisplay,0) + "}";
+    if (!axisOk()) return;
+    const uint8_t ax = currentAxis();
+    bool changed = false, refused = false;
+    if (server.hasArg("turns")) { float v = server.arg("turns").toFloat(); if (v > 0.0f) { if (cbSetTurns && !cbSetTurns(v)) refused = true; else { openTurnsDisplay[ax] = v; changed = true; } } }
+    if (server.hasArg("speed") && !refused) { float v = server.arg("speed").toFloat(); if (v > 0.0f) { if (cbSetSpeed && !cbSetSpeed(v)) refused = true; else { speedDisplay[ax] = v; changed = true; } } }
+    if (server.hasArg("accel") && !refused) { float v = server.arg("accel").toFloat(); if (v > 0.0f) { if (cbSetAccel && !cbSetAccel(v)) refused = true; else { accelDisplay[ax] = v; changed = true; } } }
+    if (refused) { sendJsonError(409, "axe occupé (homing, mesure ou autotune)"); return; }
+    String json = "{" "\"turns\":" + String(openTurnsDisplay[ax],2) + "," "\"speed\":" + String(speedDisplay[ax],0) + "," "\"accel\":" + String(accelDisplay[ax],0) + "}";
     server.send(changed ? 200 : 400, "application/json", json);
   }
 
+  // Valeur brute de "key" dans un objet JSON plat (pas d'imbrication) ; chaîne vide si absente.
+  static String jsonField(const String& obj, const char* key) {
+    String k = String("\"") + key + "\"";
+    int p = obj.indexOf(k); if (p < 0) return String();
+    p = obj.indexOf(':', p + k.length()); if (p < 0) return String();
+    p++;
+    while (p < (int)obj.length() && obj[p] == ' ') p++;
+    if (p < (int)obj.length() && obj[p] == '"') { int e = obj.indexOf('"', p + 1); return (e < 0) ? String() : obj.substring(p + 1, e); }
+    int e = p; while (e < (int)obj.length() && obj[e] != ',' && obj[e] != '}') e++;
+    String v = obj.substring(p, e); v.trim(); return v;
+  }
+
+  static bool parseOpKind(const String& name, uint8_t& kind) {
+    if      (name == "open")    kind = OP_OPEN;
+    else if (name == "close")   kind = OP_CLOSE;
+    else if (name == "stop")    kind = OP_STOP;
+    else if (name == "measure") kind = OP_MEASURE;
+    else if (name == "autotune") kind = OP_AUTOTUNE;
+    else if (name == "turns")   kind = OP_TURNS;
+    else if (name == "speed")   kind = OP_SPEED;
+    else if (name == "accel")   kind = OP_ACCEL;
+    else return false;
+    return true;
+  }
+
+  // POST /cmd  {"ops":[{"op":"speed","value":1600},{"op":"accel","value":900},{"op":"open"}]}
+  // Tout le lot est accepté ou refusé ; réponse {"ids":[...]} (un id par opération, dans l'ordre).
+  void handleCmd() {
+    if (!isAuthenticated) { sendJsonError(403, "Non autorisé"); return; }
+    if (!axisOk()) return;
+    String body = server.hasArg("plain") ? server.arg("plain") : server.arg("ops");
+    int p = body.indexOf('[');
+    if (p < 0) { sendJsonError(400, "lot absent"); return; }
+
+    WebUI_Op ops[WEBUI_MAX_BATCH_OPS]; uint8_t n = 0;
+    for (;;) {
+      int b = body.indexOf('{', p); if (b < 0) break;
+      int e = body.indexOf('}', b); if (e < 0) { sendJsonError(400, "JSON invalide"); return; }
+      if (n == WEBUI_MAX_BATCH_OPS) { sendJsonError(400, "trop d'opérations"); return; }
+      String obj = body.substring(b, e + 1);
+      if (!parseOpKind(jsonField(obj, "op"), ops[n].kind)) { sendJsonError(400, "op inconnue"); return; }
+      ops[n].value = 0.0f;
+      if (ops[n].kind >= OP_TURNS) {
+        ops[n].value = jsonField(obj, "value").toFloat();
+        if (ops[n].value <= 0.0f) { sendJsonError(400, "value invalide"); return; }
+      }
+      n++; p = e + 1;
+    }
+    if (n == 0) { sendJsonError(400, "lot vide"); return; }
+
+    uint32_t ids[WEBUI_MAX_BATCH_OPS];
+    if (!cbBatch) { sendJsonError(404, "lot indisponible"); return; }
+    switch (cbBatch(ops, n, ids)) {
+      case BATCH_OK: break;
+      case BATCH_STOP_ORDER: sendJsonError(400, "stop uniquement avant les mouvements du lot"); return;
+      case BATCH_SETTINGS_LOCKED: sendJsonError(409, "réglages refusés : axe occupé (homing, mesure ou autotune)"); return;
+      default: sendJsonError(409, "lot refusé (file pleine)"); return;
+    }
+
+    // Affichage des réglages mis à jour par l'automate quand ils s'appliquent (setSpeedDisplay...)
+    String json = "{\"ids\":[";
+    for (uint8_t i = 0; i < n; i++) {
+      if (i) json += ",";
+      json += String(ids[i]);
+    }
+    json += "]}";
+    pushLog("[CMD] Lot de " + String(n) + " opération(s), ids " + String(ids[0]) + ".." + String(ids[n - 1]));
+    server.send(200, "application/json", json);
+  }
+
+  // GET /done?id=N — état d'une commande ; position finale et durée une fois terminée.
+  void handleDone() {
+    if (!isAuthenticated) { sendJsonError(403, "Non autorisé"); return; }
+    if (!server.hasArg("id")) { sendJsonError(400, "Parameter 'id' missing"); return; }
+    static const char* kStateNames[] = { "unknown", "queued", "running", "done", "stopped", "fault", "dropped" };
+    uint32_t id = (uint32_t)strtoul(server.arg("id").c_str(), nullptr, 10);
+    WebUI_CmdInfo info{};
+    if (!cbGetCmd || !cbGetCmd(id, &info)) info.state = CMD_UNKNOWN;
+    if (info.state > CMD_DROPPED) info.state = CMD_UNKNOWN;
+    String json = "{" "\"id\":" + String(id) + "," "\"state\":\"" + kStateNames[info.state] + "\"," "\"pos\":" + String(info.posTurns,2) + "," "\"ms\":" + String(info.elapsedMs) + "}";
+    server.sendHeader("Cache-Control","no-cache");
+    server.send(info.state == CMD_UNKNOWN ? 404 : 200, "application/json", json);
+  }
+
+  // GET /trace?on=1|0[&once=1] — démarre/arrête l'enregistrement ; sans argument : état.
+  // once=1 : arrêt quand l'anneau est plein (début de course conservé).
+  void handleTrace() {
+    if (!isAuthenticated) { sendJsonError(403, "Non autorisé"); return; }
+    if (!axisOk()) return;
+    if (!cbTraceInfo) { sendJsonError(404, "trace indisponible"); return; }
+    if (server.hasArg("on") && cbTraceEnable) {
+      bool on = server.arg("on") != "0";
+      cbTraceEnable(on, server.arg("once") == "1");
+      pushLog(on ? "[TRACE] Enregistrement démarré" : "[TRACE] Enregistrement arrêté");
+    }
+    WebUI_TraceInfo ti{}; cbTraceInfo(&ti);
+    String json = "{" "\"on\":" + String(ti.enabled ? "true" : "false") + "," "\"once\":" + String(ti.once ? "true" : "false") + "," "\"count\":" + String(ti.count) + "," "\"dropped\":" + String(ti.dropped) + "}";
+    server.send(200, "application/json", json);
+  }
+
+  static void putLe32(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24); }
+
+  // GET /trace.bin — en-tête 16 octets (little-endian) puis count mots de 32 bits :
+  //   "KTR1" | u16 count | u16 réservé | u32 dropped | u32 stepsPerRev
+  // Envoi par blocs de 64 événements pour ne pas dupliquer l'anneau en RAM.
+  void handleTraceBin() {
+    if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; }
+    if (!axisOk() || refuseWhileMoving()) return;
+    if (!cbTraceInfo || !cbTraceRead) { server.send(404,"text/plain","trace indisponible"); return; }
+    WebUI_TraceInfo ti{}; cbTraceInfo(&ti);
+
+    uint8_t hdr[16] = { 'K', 'T', 'R', '1' };
+    hdr[4] = (uint8_t)ti.count; hdr[5] = (uint8_t)(ti.count >> 8);
+    putLe32(hdr + 8, ti.dropped);
+    putLe32(hdr + 12, ti.stepsPerRev);
+
+    server.setContentLength(sizeof(hdr) + (size_t)ti.count * 4);
+    server.sendHeader("Content-Disposition", "attachment; filename=trace.bin");
+    server.send(200, "application/octet-stream", "");
+    server.sendContent((const char*)hdr, sizeof(hdr));
+
+    uint32_t words[64];
+    uint8_t bytes[sizeof(words)];
+    for (uint16_t from = 0; from < ti.count; ) {
+      uint16_t n = cbTraceRead(from, words, 64);
+      if (!n) break;
+      for (uint16_t i = 0; i < n; i++) putLe32(bytes + 4 * i, words[i]);
+      server.sendContent((const char*)bytes, (size_t)n * 4);
+      from += n;
+    }
+  }
+
+  static String aggJson(const CycleAgg& a) {
+    return "{" "\"n\":" + String(a.n) + "," "\"mean_ms\":" + String(a.meanMs,0) + "," "\"p95_ms\":" + String(a.p95Ms.value(),0)
+         + "," "\"trend_pct\":" + String(a.trendPct(),1) + "," "\"peak_pct\":" + String(a.meanPeak*100.0f,1) + "}";
+  }
+
+  // GET /cycles[?axis=N][&fmt=csv] — dernières courses + agrégats par sens (ouverture / fermeture).
+  // Colonnes : seq, sens (O/C), durée ms, pas, pic % de vmax, T °C, événements (S = stop, R = inversion).
+  void handleCycles() {
+    if (!isAuthenticated) { sendJsonError(403, "Non autorisé"); return; }
+    if (!axisOk() || refuseWhileMoving()) return;
+    if (!cbGetCycles) { sendJsonError(404, "statistiques indisponibles"); return; }
+    const CycleStats* cs = cbGetCycles();
+    const bool csv = server.arg("fmt") == "csv";
+    String currentTag = String(cs->total()) + (csv ? "c" : "j");
+    String inm; if (server.hasHeader("If-None-Match")) inm = server.header("If-None-Match");
+    server.sendHeader("Cache-Control","no-cache");
+    if (inm == currentTag) { server.send(304); return; }
+
+    String out;
+    if (csv) out = "seq,dir,ms,steps,peak_pct,temp_c,events\n";
+    else out = "{" "\"open\":" + aggJson(cs->agg(true)) + "," "\"close\":" + aggJson(cs->agg(false))
+             + "," "\"total\":" + String(cs->total()) + "," "\"interrupted\":" + String(cs->interrupted()) + "," "\"cycles\":[";
+    out.reserve(out.length() + (size_t)cs->count() * 48);
+    for (uint16_t i = 0; i < cs->count(); i++) {
+      const CycleEntry& e = cs->at(i);
+      String ev; if (e.events & CYC_EV_STOPPED) ev += 'S'; if (e.events & CYC_EV_REVERSED) ev += 'R';
+      String row = String(e.seq) + "," + (csv ? String(e.opening ? "O" : "C") : String(e.opening ? "\"O\"" : "\"C\""))
+                 + "," + String(e.durationMs) + "," + String(e.steps) + "," + String(e.peakPermille / 10.0f, 1)
+                 + "," + String(e.tempDeciC / 10.0f, 1) + "," + (csv ? ev : "\"" + ev + "\"");
+      if (csv) out += row + "\n";
+      else out += (i ? ",[" : "[") + row + "]";
+    }
+    if (!csv) out += "]}";
+
+    server.sendHeader("ETag", currentTag);
+    server.send(200, csv ? "text/csv" : "application/json", out);
+  }
+
   void handleLogs() {
     if (!isAuthenticated) { server.send(403,"text/plain","Non autorisé"); return; }
     String inm; if (server.hasHeader("If-None-Match")) inm = server.header("If-None-Match");
     String currentTag = String(logsVer);
     server.sendHeader("Cache-Control","no-cache");
     if (inm == currentTag) { server.send(304); return; }
+    if (refuseWhileMoving()) return;
     server.sendHeader("ETag", currentTag);
     server.send(200,"text/plain",logs);
   }
 
   void handleStatus() {
     if (!isAuthenticated) { server.send(403, "application/json", "{\"error\":\"Non autorisé\"}"); return; }
+    if (!axisOk()) return;
+    const uint8_t ax = currentAxis();
     WebUI_Status st{}; if (cbGetStatus) cbGetStatus(&st);
-    String currentTag = String((unsigned long)((st.tempC*10.0f) + st.posTurns*100.0f + st.cycles + st.lastCalibMs + speedDisplay + accelDisplay));
+    String currentTag = String((unsigned long)((st.tempC*10.0f) + st.posTurns*100.0f + st.cycles + st.lastCalibMs + speedDisplay[ax] + accelDisplay[ax])) + "-" + String(st.deratePct) + (st.driverOn ? "e" : "d");
     String inm; if (server.hasHeader("If-None-Match")) inm = server.header("If-None-Match");
     server.sendHeader("Cache-Control","no-cache");
     if (inm == currentTag) { server.send(304); return; }
-    String json = "{" "\"temp\":" + String(st.tempC,2) + "," "\"lastCalib\":" + String((millis()-st.lastCalibMs)/1000) + "," "\"pos\":" + String(st.posTurns,2) + "," "\"cycles\":" + String(st.cycles) + "," "\"speed\":" + String(speedDisplay,0) + "," "\"accel\":" + String(accelDisplay,0) + "}";
+    String json = "{" "\"temp\":" + String(st.tempC,2) + "," "\"lastCalib\":" + String((millis()-st.lastCalibMs)/1000) + "," "\"pos\":" + String(st.posTurns,2) + "," "\"cycles\":" + String(st.cycles) + "," "\"speed\":" + String(speedDisplay[ax],0) + "," "\"accel\":" + String(accelDisplay[ax],0) + "," "\"derate\":" + String(st.deratePct) + "," "\"driver\":" + String(st.driverOn ? "true" : "false") + "}";
     server.sendHeader("ETag", currentTag);
     server.send(200, "application/json", json);
   }
@@ -128,6 +353,17 @@ void WebUI::setCallbacks(VoidCb onOpen, VoidCb onClose, VoidCb onStop, VoidCb on
   cbGetStatus = getStatus;
 }
 
+void WebUI::setCmdCallbacks(CmdBatchCb onBatch, GetCmdCb getCmd) {
+  cbBatch = onBatch; cbGetCmd = getCmd;
+}
+
+void WebUI::setTraceCallbacks(TraceEnableCb onEnable, TraceInfoCb getInfo, TraceReadCb read) {
+  cbTraceEnable = onEnable; cbTraceInfo = getInfo; cbTraceRead = read;
+}
+
+void WebUI::setCyclesCallback(GetCyclesCb getCycles) { cbGetCycles = getCycles; }
+void WebUI::setAutotuneCallback(VoidCb onAutotune) { cbAutotune = onAutotune; }
+
 void WebUI::begin(const char* ssid, const char* wifiPwd) {
   WiFi.mode(WIFI_STA);
   WiFi.begin(ssid, wifiPwd);
@@ -142,9 +378,19 @@ void WebUI::begin(const char* ssid, const char* wifiPwd) {
   server.on("/close", handleClose);
   server.on("/stop", handleStop);
   server.on("/measure", handleMeasure);
+  server.on("/autotune", handleAutotune);
   server.on("/set", handleSet);
   server.on("/logs", handleLogs);
   server.on("/status", handleStatus);
+  server.on("/cmd", handleCmd);
+  server.on("/done", handleDone);
+  server.on("/trace", handleTrace);
+  server.on("/trace.bin", handleTraceBin);
+  server.on("/cycles", handleCycles);
+
+  // ESP8266WebServer ne conserve que les en-têtes demandés : sans ceci, pas de 304
+  static const char* kHeaderKeys[] = { "If-None-Match" };
+  server.collectHeaders(kHeaderKeys, 1);
 
   server.begin();
   Serial.println("[START] Serveur HTTP démarré");
@@ -152,7 +398,10 @@ void WebUI::begin(const char* ssid, const char* wifiPwd) {
 }
 
 void WebUI::loop() { server.handleClient(); }
+void WebUI::setMotionBusy(bool busy) { motionBusy = busy; }
 void WebUI::addLog(const String& msg) { pushLog(msg); }
-void WebUI::setOpenTurns(float v) { openTurnsDisplay = v; }
-void WebUI::setSpeedDisplay(float v) { speedDisplay = v; }
-void WebUI::setAccelDisplay(float v) { accelDisplay = v; }
+void WebUI::setAxisCount(uint8_t n) { axisCount = (n < 1) ? 1 : n; }
+uint8_t WebUI::requestAxis() { return currentAxis(); }
+void WebUI::setOpenTurns(float v, uint8_t axis) { if (axis < WEBUI_MAX_AXES) openTurnsDisplay[axis] = v; }
+void WebUI::setSpeedDisplay(float v, uint8_t axis) { if (axis < WEBUI_MAX_AXES) speedDisplay[axis] = v; }
+void WebUI::setAccelDisplay(float v, uint8_t axis) { if (axis < WEBUI_MAX_AXES) accelDisplay[axis] = v; }
@@ -2,16 +2,60 @@
 #include <Arduino.h>
 #include <ESP8266WebServer.h>
 #include <ESP8266WiFi.h>
+#include "CycleStats.h"
 
 typedef void (*VoidCb)();
-typedef void (*SetFloatCb)(float);
+typedef bool (*SetFloatCb)(float);   // false : réglage refusé (axe en homing, mesure ou autotune)
 typedef void (*GetStatusCb)(void*);
 
+// ---- API /cmd : lot d'opérations + suivi par identifiant ----
+enum WebUI_OpKind : uint8_t { OP_OPEN, OP_CLOSE, OP_STOP, OP_MEASURE, OP_AUTOTUNE, OP_TURNS, OP_SPEED, OP_ACCEL };
+
+struct WebUI_Op {
+  uint8_t kind;   // WebUI_OpKind
+  float value;    // utilisé par OP_TURNS / OP_SPEED / OP_ACCEL
+};
+
+enum WebUI_CmdState : uint8_t { CMD_UNKNOWN, CMD_QUEUED, CMD_RUNNING, CMD_DONE, CMD_STOPPED, CMD_FAULT, CMD_DROPPED };
+
+struct WebUI_CmdInfo {
+  uint8_t state;            // WebUI_CmdState
+  float posTurns;           // position finale (ou courante si en cours)
+  unsigned long elapsedMs;  // durée du mouvement
+};
+
+static const uint8_t WEBUI_MAX_BATCH_OPS = 8;
+static const uint8_t WEBUI_MAX_AXES = 4;
+
+// Résultat d'un lot : appliqué en entier, ou refusé sans effet (raison)
+enum WebUI_BatchResult : uint8_t { BATCH_OK, BATCH_QUEUE_FULL, BATCH_STOP_ORDER, BATCH_SETTINGS_LOCKED };
+
+// Applique un lot complet ou rien. Remplit ids[n] si BATCH_OK.
+typedef uint8_t (*CmdBatchCb)(const WebUI_Op* ops, uint8_t n, uint32_t* ids);
+typedef bool (*GetCmdCb)(uint32_t id, WebUI_CmdInfo* out);
+
+// ---- Trace des pas (/trace, /trace.bin) ----
+struct WebUI_TraceInfo {
+  bool enabled;
+  bool once;              // arrêt quand l'anneau est plein
+  uint16_t count;         // événements disponibles
+  uint32_t dropped;       // événements écrasés (anneau plein)
+  uint32_t stepsPerRev;
+};
+typedef void (*TraceEnableCb)(bool on, bool once);
+typedef void (*TraceInfoCb)(WebUI_TraceInfo* out);
+typedef uint16_t (*TraceReadCb)(uint16_t from, uint32_t* dst, uint16_t n);
+
+// ---- Statistiques de courses (/cycles) : lues directement dans l'objet de l'axe ----
+typedef const CycleStats* (*GetCyclesCb)();
+
 struct WebUI_Status {
   float tempC;
   unsigned long lastCalibMs;
   float posTurns;
   unsigned long cycles;
+  int deratePct;          // facteur thermique appliqué aux vitesses (%)
+  bool driverOn;          // ENABLE actif (false = coupé au repos)
   IPAddress ip;
   unsigned long uptimeSec;
   int usedRamPercent;
@@ -23,10 +67,20 @@ namespace WebUI {
   void setCallbacks(VoidCb onOpen, VoidCb onClose, VoidCb onStop, VoidCb onMeasure,
                     SetFloatCb onSetTurns, SetFloatCb onSetSpeed,
                     SetFloatCb onSetAccel, GetStatusCb getStatus);
+  void setCmdCallbacks(CmdBatchCb onBatch, GetCmdCb getCmd);
+  void setTraceCallbacks(TraceEnableCb onEnable, TraceInfoCb getInfo, TraceReadCb read);
+  void setCyclesCallback(GetCyclesCb getCycles);
+  void setAutotuneCallback(VoidCb onAutotune);
   void begin(const char* ssid, const char* wifiPwd);
   void loop();
+  // true pendant un mouvement : page, /logs (hors 304), /cycles et /trace.bin répondent 503
+  void setMotionBusy(bool busy);
   void addLog(const String& msg);
-  void setOpenTurns(float turns);
-  void setSpeedDisplay(float speed_steps_per_s);
-  void setAccelDisplay(float accel_steps2_per_s);
+  // Nombre d'axes routables par ?axis=N (1..WEBUI_MAX_AXES, vérifié à la compilation dans FSM.h)
+  void setAxisCount(uint8_t n);
+  // Axe visé par la requête en cours (?axis=N, 0 par défaut) ; à lire dans les callbacks
+  uint8_t requestAxis();
+  void setOpenTurns(float turns, uint8_t axis = 0);
+  void setSpeedDisplay(float speed_steps_per_s, uint8_t axis = 0);
+  void setAccelDisplay(float accel_steps2_per_s, uint8_t axis = 0);
 }
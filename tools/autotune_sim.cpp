@@ -0,0 +1,201 @@
+// autotune_sim.cpp — simulation hôte de la recherche AUTOTUNE (AutoTune + CounterControl réels)
+//
+// Modèle moteur : tools/host/motor_model.h (couple selon la vitesse, sans effet de température).
+// La position physique (et non la position comptée) commande le fin de course, actif bas :
+// les pas perdus se voient à la fermeture, comme sur le comptoir.
+// Modèle thermique optionnel : échauffement en mouvement, refroidissement exponentiel à l'arrêt.
+// Déclassement kDerateCurve actif comme sur le comptoir ; AutoTune doit le suspendre pendant la
+// recherche (sinon le profil essayé n'est pas celui demandé). Un départ à chaud (ambiant 55 °C,
+// sous TUNE_TEMP_MAX_C mais dans la courbe) doit donner le même résultat qu'à 25 °C.
+// La recherche est ensuite rejouée par l'automate (FSM.h) avec un réglage de vitesse envoyé en
+// cours de route : il doit être refusé (409 côté WebUI), sans changer le résultat.
+//
+// Build (hôte) : g++ -std=c++17 -O2 -Itools/host -I. -o autotune_sim tools/autotune_sim.cpp WebUI.cpp
+// Usage        : ./autotune_sim [A0_tr_s2=12] [vdecroche_tr_s=3] [afrott_tr_s2=1] [chauffe_c_s=0] [loop_us=20]
+//                               [ambiant_c=25]
+
+#define KISS_TRACE_DEPTH 0
+#include "FSM.h"
+#include "motor_model.h"
+
+#include <cstdio>
+
+AxisFsm axes[AXIS_COUNT];  // état d'automate rejoué (FSM.h)
+
+namespace {
+
+struct Thermal {
+  float heatCs;                  // °C/s en mouvement
+  float ambientC = 25.0f, tauS = 120.0f;
+  float tempC = 25.0f;
+  void step(bool moving, float dtS) {
+    if (moving) tempC += heatCs * dtS;
+    else tempC += (ambientC - tempC) * dtS / tauS;
+  }
+};
+
+CounterControl ctrl;
+Motor motor;
+Thermal thermal;
+unsigned loopUs = 20;
+
+void setupCtrl() {
+  ctrl = CounterControl();
+  ctrl.begin(STEP_PIN, DIR_PIN, -1, ENA_ACTIVE_LOW, LIMIT_BOTTOM, true, kStepsPerRev, kOpenTurns);
+  SpeedZone zones[kDefaultZoneCount];
+  ctrl.setSpeedZones(zones, defaultSpeedZones(zones, kOpenTurns));
+  ctrl.setDerateCurve(kDerateCurve, kDerateCurveLen);
+  ctrl.setTemperature(thermal.tempC);
+  motor.reset();
+}
+
+// Un passage de loop() : entrées, pas éventuel, modèle moteur, fin de course réel
+void loopOnce() {
+  ctrl.pollInputs();
+  long before = ctrl.positionSteps();
+  if (ctrl.motor.run()) motor.onStep((int)(ctrl.positionSteps() - before), ctrl.motor.speed());
+  hostPinLevel[LIMIT_BOTTOM] = motor.phys <= 0 ? LOW : HIGH;
+  thermal.step(ctrl.isMoving(), loopUs * 1e-6f);
+  ctrl.setTemperature(thermal.tempC);  // appliqué au prochain arrêt
+  hostClockUs += loopUs;
+}
+
+// Cycles ouverture + fermeture à profil fixe : temps moyen d'un cycle et pas perdus
+double runCycles(float v, float a, int n, long& lost) {
+  setupCtrl();
+  ctrl.setMaxSpeedSteps(v);
+  ctrl.setAccelerationSteps2(a);
+  const unsigned long t0 = hostClockUs;
+  for (int i = 0; i < n; i++) {
+    for (int dir = 1; dir >= -1; dir -= 2) {
+      ctrl.pollInputs();  // passage à l'arrêt : déclassement éventuel appliqué
+      ctrl.motor.setDirection(dir);
+      if (dir > 0) ctrl.open(); else ctrl.close();
+      while (ctrl.isMoving()) loopOnce();
+    }
+  }
+  lost = labs(motor.phys - ctrl.positionSteps()) + motor.lost;
+  return (hostClockUs - t0) * 1e-6 / n;
+}
+
+// Même recherche pilotée par fsmTick(), réglage de vitesse tenté après 20 s simulées.
+// true si le réglage a été refusé, que le résultat est celui de la recherche directe (v, a)
+// et qu'un réglage est de nouveau accepté une fois l'axe revenu en IDLE.
+bool runSettingDuringTune(float v, float a) {
+  setupCtrl();
+  thermal.tempC = thermal.ambientC;
+  AxisFsm& ax = axes[0];
+  ax.ctrl = &ctrl;
+  ax.st = State::IDLE;
+  ax.openTurns = kOpenTurns;
+  ax.vmaxSteps = kVmaxSteps;
+  ax.accelSteps2 = kAccelSteps2;
+  applyMotionParams(ax);
+  setPending(ax, Cmd::AUTOTUNE, newCmdId());
+
+  const float tried = 3.0f * kStepsPerRev;
+  const unsigned long t0 = hostClockUs;
+  bool sent = false, refused = false;
+  latestTempC = thermal.tempC;
+  fsmTick(ax);
+  while (ax.st == State::AUTOTUNE) {
+    loopOnce();
+    latestTempC = thermal.tempC;
+    fsmTick(ax);
+    if (!sent && hostClockUs - t0 > 20UL * 1000000UL) {
+      sent = true;
+      refused = !applySetting(ax, Cmd::SET_SPEED, tried);
+    }
+    if (hostClockUs - t0 > 3600UL * 1000000UL) break;
+  }
+  const bool sameResult = ax.st == State::IDLE && ax.vmaxSteps == v && ax.accelSteps2 == a;
+  const float vGot = ax.vmaxSteps, aGot = ax.accelSteps2;
+  const bool acceptedAfter = applySetting(ax, Cmd::SET_SPEED, tried) && ax.vmaxSteps == tried;
+  printf("réglage %.2f tr/s pendant la recherche : %s ; résultat %.3f tr/s, %.3f tr/s² (%s) ; "
+         "accepté ensuite : %s\n", tried / kStepsPerRev, !sent ? "non envoyé" : refused ? "refusé" : "APPLIQUÉ",
+         vGot / kStepsPerRev, aGot / kStepsPerRev, sameResult ? "identique" : "DIFFÉRENT",
+         acceptedAfter ? "oui" : "non");
+  return sent && refused && sameResult && acceptedAfter;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const float spr = (float)kStepsPerRev;
+  motor.a0        = (argc > 1 ? (float)atof(argv[1]) : 12.0f) * spr;
+  motor.vPullout  = (argc > 2 ? (float)atof(argv[2]) : 3.0f) * spr;
+  motor.aFriction = (argc > 3 ? (float)atof(argv[3]) : 1.0f) * spr;
+  thermal.heatCs  = argc > 4 ? (float)atof(argv[4]) : 0.0f;
+  loopUs          = argc > 5 ? (unsigned)atoi(argv[5]) : 20u;
+  thermal.ambientC = argc > 6 ? (float)atof(argv[6]) : 25.0f;
+  thermal.tempC   = thermal.ambientC;
+
+  printf("modèle : A0 %.1f tr/s², décrochage %.2f tr/s, frottement %.1f tr/s², chauffe %.2f °C/s, loop %u µs\n",
+         motor.a0 / spr, motor.vPullout / spr, motor.aFriction / spr, thermal.heatCs, loopUs);
+  printf("départ : %.2f tr/s, %.3f tr/s² ; marge %.0f %%, arrêt à %.0f °C\n",
+         kVmaxSteps / spr, kAccelSteps2 / spr, TUNE_MARGIN * 100.0f, TUNE_TEMP_MAX_C);
+
+  setupCtrl();
+  ctrl.pollInputs();  // facteur de la température de départ appliqué (axe à l'arrêt)
+  printf("ambiant %.0f °C : déclassement x%.2f hors recherche\n\n", thermal.ambientC, ctrl.derateFactor());
+  AutoTune tuner;
+  tuner.begin(ctrl, kVmaxSteps, kAccelSteps2);
+  const unsigned long t0 = hostClockUs;
+
+  printf("%3s %9s %10s %9s %8s %7s %s\n", "n", "v tr/s", "a tr/s²", "pic tr/s", "écart", "T °C", "");
+  bool strokeConfirm = false;
+  bool derated = false;  // déclassement appliqué pendant une course de recherche
+  int n = 0;
+  uint8_t ev = TUNE_BUSY;
+  while (ev != TUNE_DONE && ev != TUNE_FAILED) {
+    if (ctrl.isMoving()) {
+      strokeConfirm = tuner.confirming();
+      if (ctrl.derateFactor() < 1.0f) derated = true;
+    }
+    loopOnce();
+    ev = tuner.tick(thermal.tempC);
+    if (ev == TUNE_STROKE_OK || ev == TUNE_STROKE_LOST) {
+      n++;
+      printf("%3d %9.3f %10.3f %9.3f %8ld %7.1f %s%s\n", n, tuner.lastSpeed() / spr, tuner.lastAccel() / spr, tuner.lastPeak() / spr,
+             tuner.lastError(), thermal.tempC, ev == TUNE_STROKE_OK ? "OK" : "PERTE",
+             strokeConfirm ? " (validation)" : "");
+      motor.lost = 0;
+      motor.stalled = false;
+    }
+    if (hostClockUs - t0 > 3600UL * 1000000UL) { printf("ÉCHEC : recherche > 1 h simulée\n"); return 1; }
+  }
+  const double tuneS = (hostClockUs - t0) * 1e-6;
+
+  if (ev == TUNE_FAILED) {
+    printf("\nÉCHEC : %s\n", tuner.lostReference() ? "fin de course introuvable" : "profil de départ non fiable");
+    return 1;
+  }
+
+  const float v = tuner.resultSpeed(), a = tuner.resultAccel();
+  printf("\nrésultat : %.3f tr/s, %.3f tr/s²%s (recherche %.0f s simulées, %d courses)\n",
+         v / spr, a / spr, tuner.tempLimited() ? " [limité par la température]" : "", tuneS, n);
+
+  // Marge réelle du résultat dans le modèle : a + frottement vs couple disponible à vmax
+  float avail = motor.available(v);
+  printf("modèle à %.3f tr/s : besoin %.2f tr/s², disponible %.2f tr/s²\n", v / spr, (a + motor.aFriction) / spr, avail / spr);
+
+  long lostDefault = 0, lostTuned = 0;
+  double cycDefault = runCycles(kVmaxSteps, kAccelSteps2, 3, lostDefault);
+  double cycTuned   = runCycles(v, a, 20, lostTuned);
+  printf("cycle ouverture+fermeture : réglage d'origine %.2f s, réglage trouvé %.2f s (%.0f %% plus rapide)\n",
+         cycDefault, cycTuned, 100.0 * (1.0 - cycTuned / cycDefault));
+  printf("20 cycles au réglage trouvé : %ld pas perdus\n", lostTuned);
+
+  // Même limitée par la température, la recherche ne doit jamais rendre un profil plus lent
+  // (arrêt thermique dès la première course : profil de départ rendu tel quel, sans gain)
+  bool notBelowStart = v >= kVmaxSteps && a >= kAccelSteps2;
+  bool unchanged = v == kVmaxSteps && a == kAccelSteps2;
+  const bool settingOk = runSettingDuringTune(v, a);
+  bool ok = !derated && settingOk && lostTuned == 0 && notBelowStart && (cycTuned < cycDefault || unchanged);
+  if (derated) printf("ÉCHEC : déclassement appliqué pendant la recherche\n");
+  if (!settingOk) printf("ÉCHEC : réglage pris en compte pendant la recherche, ou résultat modifié\n");
+  printf("%s\n", !ok ? "ÉCHEC : pertes au réglage trouvé, profil sous le départ ou aucun gain"
+                 : unchanged ? "OK : profil de départ conservé (arrêt thermique), aucune perte de pas"
+                             : "OK : profil plus rapide, aucune perte de pas");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Arduino.h (hôte) — juste assez d'API Arduino pour compiler StepperKiss.h et
+// CounterControl.h sur PC (simulateurs de tools/), et le firmware complet (tools/webui_load).
+// Horloge virtuelle : micros()/millis() lisent hostClockUs, que le simulateur avance ;
+// delayMicroseconds() (impulsion STEP) avance aussi l'horloge.
+// hostMicrosCostUs : avance de l'horloge à chaque micros(), modèle grossier du coût CPU
+// d'un run() (un appel par run()) pour les bancs de jitter ; 0 par défaut.
+// hostMicrosFreeCalls : nombre de prochains micros() non facturés (simple lecture d'horloge).
+// HOST_REAL_CLOCK : micros()/millis() lisent l'horloge monotone du PC, delay() dort,
+// delayMicroseconds() attend activement (firmware réel + serveur HTTP sur socket).
+// Broches : hostPinLevel[] ; digitalWrite l'écrit (puis hostPinHook), digitalRead le lit.
+// Serial : sortie jetée ; chaque write() passe par hostSerialHook, qui peut répondre via
+// hostSerialFeed() (émulation de la Nano).
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#ifdef HOST_REAL_CLOCK
+  #include <chrono>
+  #include <thread>
+#endif
+#include "WString.h"
+
+#define HIGH 1
+#define LOW  0
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+
+typedef uint32_t uint32;
+
+inline unsigned long hostClockUs = 0;
+inline unsigned long hostMicrosCostUs = 0;
+inline unsigned hostMicrosFreeCalls = 0;
+inline uint8_t hostPinLevel[64] = {};
+inline void (*hostPinHook)(uint8_t pin, uint8_t level) = nullptr;
+
+#ifdef HOST_REAL_CLOCK
+inline unsigned long micros() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+inline unsigned long millis() { return micros() / 1000UL; }
+inline void delayMicroseconds(unsigned int us) { unsigned long t = micros(); while (micros() - t < us) {} }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+#else
+inline unsigned long micros() {
+  unsigned long t = hostClockUs;
+  if (hostMicrosFreeCalls) hostMicrosFreeCalls--;
+  else hostClockUs += hostMicrosCostUs;
+  return t;
+}
+inline unsigned long millis() { return hostClockUs / 1000UL; }
+inline void delayMicroseconds(unsigned int us) { hostClockUs += us; }
+inline void delay(unsigned long ms) { hostClockUs += ms * 1000UL; }
+#endif
+inline void yield() {}
+
+template <class T> inline T constrain(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) { if (mode == INPUT_PULLUP && pin < 64) hostPinLevel[pin] = HIGH; }
+inline void digitalWrite(uint8_t pin, uint8_t v) {
+  if (pin >= 64) return;
+  hostPinLevel[pin] = v ? HIGH : LOW;
+  if (hostPinHook) hostPinHook(pin, hostPinLevel[pin]);
+}
+inline int  digitalRead(uint8_t pin) { return pin < 64 ? hostPinLevel[pin] : LOW; }
+
+// Port série : rien n'est affiché, les octets reçus viennent de hostSerialFeed()
+inline void (*hostSerialHook)(uint8_t c) = nullptr;
+inline std::deque<uint8_t> hostSerialRx;
+inline void hostSerialFeed(const char* s) { while (*s) hostSerialRx.push_back((uint8_t)*s++); }
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  int available() const { return (int)hostSerialRx.size(); }
+  int read() {
+    if (hostSerialRx.empty()) return -1;
+    uint8_t c = hostSerialRx.front();
+    hostSerialRx.pop_front();
+    return c;
+  }
+  size_t write(uint8_t c) { if (hostSerialHook) hostSerialHook(c); return 1; }
+  template <class T> size_t print(const T&) { return 0; }
+  template <class T> size_t println(const T&) { return 0; }
+  size_t println() { return 0; }
+};
+inline HostSerial Serial;
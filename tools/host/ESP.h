@@ -0,0 +1,12 @@
+// ESP.h (hôte) — objet ESP factice : tas libre, fréquence CPU et identifiant de puce fixes.
+
+#pragma once
+#include <Arduino.h>
+
+class HostEsp {
+public:
+  uint32_t getFreeHeap() const { return 40000; }
+  uint8_t getCpuFreqMHz() const { return 80; }
+  uint32_t getChipId() const { return 0x00C0FFEE; }
+};
+inline HostEsp ESP;
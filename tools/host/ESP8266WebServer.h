@@ -0,0 +1,266 @@
+// ESP8266WebServer.h (hôte) — sous-ensemble de l'API ESP8266WebServer servi sur un vrai
+// socket TCP local (Linux), pour faire tourner WebUI.cpp sur PC (tools/webui_load.cpp).
+// - Comme sur l'ESP8266 : un client par handleClient(), réponse puis Connection: close.
+// - header()/hasHeader() ne voient que les en-têtes déclarés par collectHeaders().
+// - Corps d'un POST non formulaire -> arg("plain") ; formulaire -> arguments.
+// - hostHttpPort remplace le port du constructeur (80 demande les droits root).
+// - Mesures par requête (hostHttpHook) : durée du handler et allocations faites pendant
+//   le handler (hostAllocCount, incrémenté par l'operator new du programme hôte).
+
+#pragma once
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+inline int hostHttpPort = 8080;
+inline thread_local unsigned long hostAllocCount = 0;
+
+struct HostHttpRecord {
+  std::string path;          // sans la query
+  int code;
+  unsigned long handlerUs;
+  unsigned long allocs;
+  size_t bytes;              // octets envoyés (en-têtes compris)
+};
+inline void (*hostHttpHook)(const HostHttpRecord& r) = nullptr;
+
+class ESP8266WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit ESP8266WebServer(int port = 80) { (void)port; }
+  ~ESP8266WebServer() { if (_listenFd >= 0) ::close(_listenFd); }
+
+  void on(const String& uri, THandlerFunction fn) { _routes.push_back({ uri.str(), fn }); }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  void collectHeaders(const char* headerKeys[], const size_t count) {
+    _collect.clear();
+    for (size_t i = 0; i < count; i++) _collect.push_back(headerKeys[i]);
+  }
+
+  void begin() {
+    _listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)hostHttpPort);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(_listenFd, (sockaddr*)&a, sizeof(a)) < 0 || ::listen(_listenFd, 128) < 0) {
+      perror("ESP8266WebServer(hôte) bind/listen");
+      exit(1);
+    }
+    ::fcntl(_listenFd, F_SETFL, O_NONBLOCK);
+  }
+
+  // Un client au plus par appel, comme le serveur de l'ESP8266
+  void handleClient() {
+    if (_listenFd < 0) return;
+    int fd = ::accept(_listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    _fd = fd;
+    if (readRequest()) dispatch();
+    ::close(fd);
+    _fd = -1;
+  }
+
+  // ---- Requête en cours ----
+  const String& uri() const { return _uri; }
+  int args() const { return (int)_args.size(); }
+  bool hasArg(const String& name) const { return findArg(name.str()) != nullptr; }
+  String arg(const String& name) const { const std::string* v = findArg(name.str()); return v ? String(*v) : String(); }
+  bool hasHeader(const String& name) const { return findHeader(name.str()) != nullptr; }
+  String header(const String& name) const { const std::string* v = findHeader(name.str()); return v ? String(*v) : String(); }
+
+  // ---- Réponse ----
+  void sendHeader(const String& name, const String& value, bool first = false) {
+    std::string h = name.str() + ": " + value.str() + "\r\n";
+    if (first) _extraHeaders.insert(0, h);
+    else _extraHeaders += h;
+  }
+  void setContentLength(size_t n) { _contentLength = n; }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String()) {
+    _code = code;
+    size_t len = (_contentLength != CONTENT_LENGTH_UNKNOWN) ? _contentLength : content.length();
+    std::string h = "HTTP/1.1 " + std::to_string(code) + " " + reason(code) + "\r\n";
+    if (contentType && contentType[0]) h += std::string("Content-Type: ") + contentType + "\r\n";
+    h += "Content-Length: " + std::to_string(len) + "\r\nConnection: close\r\n";
+    h += _extraHeaders;
+    h += "\r\n";
+    writeAll(h.data(), h.size());
+    if (content.length()) writeAll(content.c_str(), content.length());
+  }
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+
+  void sendContent(const char* data, size_t n) { writeAll(data, n); }
+  void sendContent(const String& s) { writeAll(s.c_str(), s.length()); }
+
+private:
+  struct Route { std::string uri; THandlerFunction fn; };
+  struct KV { std::string key, value; };
+
+  const std::string* findArg(const std::string& k) const {
+    for (const KV& kv : _args) if (kv.key == k) return &kv.value;
+    return nullptr;
+  }
+  const std::string* findHeader(const std::string& k) const {
+    for (const KV& kv : _headers) if (strcasecmp(kv.key.c_str(), k.c_str()) == 0) return &kv.value;
+    return nullptr;
+  }
+
+  static const char* reason(int code) {
+    switch (code) {
+      case 200: return "OK";
+      case 303: return "See Other";
+      case 304: return "Not Modified";
+      case 400: return "Bad Request";
+      case 401: return "Unauthorized";
+      case 403: return "Forbidden";
+      case 404: return "Not Found";
+      case 409: return "Conflict";
+      default:  return "Error";
+    }
+  }
+
+  void writeAll(const char* p, size_t n) {
+    _sent += n;
+    while (n > 0) {
+      ssize_t w = ::send(_fd, p, n, MSG_NOSIGNAL);
+      if (w <= 0) return;  // client parti
+      p += w;
+      n -= (size_t)w;
+    }
+  }
+
+  static std::string urlDecode(const std::string& s) {
+    std::string r;
+    for (size_t i = 0; i < s.size(); i++) {
+      if (s[i] == '+') r += ' ';
+      else if (s[i] == '%' && i + 2 < s.size() && isxdigit((unsigned char)s[i + 1]) && isxdigit((unsigned char)s[i + 2])) {
+        r += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+        i += 2;
+      } else r += s[i];
+    }
+    return r;
+  }
+
+  void parseArgs(const std::string& q) {
+    size_t p = 0;
+    while (p < q.size()) {
+      size_t amp = q.find('&', p);
+      if (amp == std::string::npos) amp = q.size();
+      std::string kv = q.substr(p, amp - p);
+      size_t eq = kv.find('=');
+      if (!kv.empty()) {
+        if (eq == std::string::npos) _args.push_back({ urlDecode(kv), "" });
+        else _args.push_back({ urlDecode(kv.substr(0, eq)), urlDecode(kv.substr(eq + 1)) });
+      }
+      p = amp + 1;
+    }
+  }
+
+  // Lit la requête complète (en-têtes + corps Content-Length), 1 s au plus
+  bool readRequest() {
+    std::string raw;
+    char buf[2048];
+    size_t headEnd = std::string::npos, need = 0;
+    unsigned long t0 = millis();
+    for (;;) {
+      if (headEnd != std::string::npos && raw.size() >= headEnd + 4 + need) break;
+      if (millis() - t0 > 1000UL) return false;
+      pollfd pfd = { _fd, POLLIN, 0 };
+      if (::poll(&pfd, 1, 100) <= 0) continue;
+      ssize_t r = ::recv(_fd, buf, sizeof(buf), 0);
+      if (r <= 0) return false;
+      raw.append(buf, (size_t)r);
+      if (headEnd == std::string::npos && (headEnd = raw.find("\r\n\r\n")) != std::string::npos) {
+        size_t cl = lowerFind(raw.substr(0, headEnd), "\ncontent-length:");
+        if (cl != std::string::npos) need = (size_t)atol(raw.c_str() + cl + 16);
+      }
+    }
+
+    _args.clear();
+    _headers.clear();
+    _extraHeaders.clear();
+    _contentLength = CONTENT_LENGTH_UNKNOWN;
+    _code = 0;
+    _sent = 0;
+
+    size_t eol = raw.find("\r\n");
+    std::string line = raw.substr(0, eol);
+    size_t sp1 = line.find(' '), sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 <= sp1) return false;
+    _method = line.substr(0, sp1);
+    std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    size_t qm = target.find('?');
+    _uri = String(target.substr(0, qm));
+    if (qm != std::string::npos) parseArgs(target.substr(qm + 1));
+
+    std::string contentType;
+    size_t p = eol + 2;
+    while (p < headEnd) {
+      size_t e = raw.find("\r\n", p);
+      std::string h = raw.substr(p, e - p);
+      p = e + 2;
+      size_t c = h.find(':');
+      if (c == std::string::npos) continue;
+      std::string k = h.substr(0, c), v = h.substr(c + 1);
+      while (!v.empty() && v[0] == ' ') v.erase(0, 1);
+      if (strcasecmp(k.c_str(), "Content-Type") == 0) contentType = v;
+      for (const std::string& want : _collect)
+        if (strcasecmp(want.c_str(), k.c_str()) == 0) _headers.push_back({ want, v });
+    }
+
+    std::string body = raw.substr(headEnd + 4, need);
+    if (!body.empty()) {
+      if (contentType.find("application/x-www-form-urlencoded") != std::string::npos) parseArgs(body);
+      else _args.push_back({ "plain", body });
+    }
+    return true;
+  }
+
+  static size_t lowerFind(std::string s, const char* needle) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s.find(needle);
+  }
+
+  void dispatch() {
+    unsigned long a0 = hostAllocCount, t0 = micros();
+    THandlerFunction fn = _notFound;
+    for (const Route& r : _routes) if (r.uri == _uri.str()) { fn = r.fn; break; }
+    if (fn) fn();
+    else send(404, "text/plain", "Not found");
+    unsigned long dt = micros() - t0, allocs = hostAllocCount - a0;
+    if (hostHttpHook) hostHttpHook({ _uri.str(), _code, dt, allocs, _sent });
+  }
+
+  int _listenFd = -1, _fd = -1;
+  std::vector<Route> _routes;
+  THandlerFunction _notFound;
+  std::vector<std::string> _collect;
+
+  std::string _method;
+  String _uri;
+  std::vector<KV> _args, _headers;
+  std::string _extraHeaders;
+  size_t _contentLength = CONTENT_LENGTH_UNKNOWN;
+  int _code = 0;
+  size_t _sent = 0;
+};
@@ -0,0 +1,28 @@
+// ESP8266WiFi.h (hôte) — WiFi toujours connecté, adresse de boucle locale.
+
+#pragma once
+#include <Arduino.h>
+
+#define WIFI_STA     1
+#define WL_CONNECTED 3
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _b{ a, b, c, d } {}
+  String toString() const {
+    char s[16];
+    snprintf(s, sizeof(s), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+    return String(s);
+  }
+private:
+  uint8_t _b[4];
+};
+
+class HostWiFi {
+public:
+  void mode(int) {}
+  void begin(const char*, const char*) {}
+  int status() const { return WL_CONNECTED; }
+  IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+};
+inline HostWiFi WiFi;
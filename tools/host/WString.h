@@ -0,0 +1,75 @@
+// WString.h (hôte) — String Arduino/ESP8266 adossée à std::string, limitée à ce qu'utilisent
+// WebUI.cpp, FSM.h et le .ino. Les allocations passent par operator new (comptées par
+// tools/webui_load) ; l'optimisation petites chaînes de libstdc++ (15 car.) diffère un peu
+// de celle du core ESP8266 : les comptes sont un ordre de grandeur, pas une valeur exacte.
+
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char* c) : _s(c ? c : "") {}
+  String(const std::string& s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int v) : _s(std::to_string(v)) {}
+  explicit String(unsigned v) : _s(std::to_string(v)) {}
+  explicit String(long v) : _s(std::to_string(v)) {}
+  explicit String(unsigned long v) : _s(std::to_string(v)) {}
+  explicit String(float v, unsigned char decimals = 2) : String((double)v, decimals) {}
+  explicit String(double v, unsigned char decimals = 2) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", (int)decimals, v);
+    _s = b;
+  }
+
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  const char* c_str() const { return _s.c_str(); }
+  unsigned char reserve(unsigned int n) { _s.reserve(n); return 1; }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return pos(_s.find(str._s, from)); }
+  int indexOf(const char* str, unsigned int from = 0) const { return pos(_s.find(str, from)); }
+
+  String substring(unsigned int from) const { return from >= _s.size() ? String() : String(_s.substr(from)); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from));
+  }
+
+  void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+  void trim() {
+    size_t a = _s.find_first_not_of(" \t\r\n");
+    size_t b = _s.find_last_not_of(" \t\r\n");
+    _s = (a == std::string::npos) ? std::string() : _s.substr(a, b - a + 1);
+  }
+
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return (float)atof(_s.c_str()); }
+
+  String& operator+=(const String& o) { _s += o._s; return *this; }
+  String& operator+=(const char* o) { if (o) _s += o; return *this; }
+  String& operator+=(char c) { _s += c; return *this; }
+
+  bool operator==(const String& o) const { return _s == o._s; }
+  bool operator==(const char* o) const { return _s == (o ? o : ""); }
+  bool operator!=(const String& o) const { return !(*this == o); }
+  bool operator!=(const char* o) const { return !(*this == o); }
+
+  const std::string& str() const { return _s; }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  std::string _s;
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b)   { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b)   { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b)          { String r(a); r += b; return r; }
@@ -0,0 +1,44 @@
+// motor_model.h (hôte) — modèle de couple du moteur pas à pas, commun aux simulations
+// (tools/autotune_sim.cpp, tools/thermal_sim.cpp).
+//
+// Le couple disponible baisse avec la vitesse et, si kTemp > 0, avec l'échauffement ; exprimé en
+// accélération utile : Adispo(v, T) = A0 · (1 - kTemp·(T - 25)) · (1 - v / vdécroche).
+// Un pas est perdu quand |a| + Afrott > Adispo. Le moteur décroche alors : plus aucun pas
+// n'avance la charge tant que la vitesse commandée reste au-dessus de vresync.
+
+#pragma once
+#include <Arduino.h>
+#include "Config.h"
+
+struct Motor {
+  float a0        = 12.0f * kStepsPerRev;  // pas/s²
+  float vPullout  = 3.0f * kStepsPerRev;   // pas/s
+  float aFriction = 1.0f * kStepsPerRev;   // pas/s²
+  float vResync   = 0.5f * kStepsPerRev;   // pas/s
+  float kTemp     = 0.0f;                  // perte de couple par °C au-dessus de 25 °C (0 : sans effet)
+  long phys = 0;                           // position réelle de la charge (pas)
+  long lost = 0;
+  bool stalled = false;
+  float prevSpeed = 0.0f;
+  unsigned long prevUs = 0;
+
+  void reset() { phys = 0; lost = 0; stalled = false; prevSpeed = 0.0f; prevUs = hostClockUs; }
+
+  float available(float v, float tempC = 25.0f) const {
+    return a0 * (1.0f - kTemp * (tempC - 25.0f)) * (1.0f - fabsf(v) / vPullout);
+  }
+
+  // Un pas vient d'être émis dans le sens dir, à la vitesse commandée speed (pas/s, signée)
+  void onStep(int dir, float speed, float tempC = 25.0f) {
+    float dt = (hostClockUs - prevUs) * 1e-6f;
+    float a = dt > 0.0f ? fabsf(speed - prevSpeed) / dt : 0.0f;
+    prevSpeed = speed;
+    prevUs = hostClockUs;
+
+    float v = fabsf(speed);
+    if (stalled && v < vResync) stalled = false;
+    if (!stalled && a + aFriction > available(v, tempC)) stalled = true;
+    if (stalled) lost++;
+    else phys += dir;
+  }
+};
@@ -0,0 +1,98 @@
+// sched_bench.cpp — banc hôte du jitter de pas par axe quand N augmente
+//
+// N axes ouvrent en même temps (vitesses décalées). Deux stratégies de loop() :
+//   - tour complet : poll() de chaque axe à chaque passage (run() intégré à chaque fois)
+//   - StepScheduler : run() des seuls axes échus, échéance la plus ancienne d'abord
+// Retard d'un pas = instant réel du pas - échéance planifiée par StepperKiss.
+//
+// Build (hôte) : g++ -std=c++17 -O2 -Itools/host -I. -o sched_bench tools/sched_bench.cpp
+// Usage        : ./sched_bench [cout_run_us=12] [loop_us=10] [vmax_tr_s=1.6]
+// cout_run_us est facturé à chaque micros() de run() ; la lecture d'horloge propre à
+// StepScheduler::poll() n'est pas facturée (≈ 1 µs sur ESP8266).
+
+#define KISS_TRACE_DEPTH 0
+#include "StepScheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct AxisStats {
+  std::vector<long> late;
+};
+
+void setupAxis(CounterControl& c, uint8_t i, float vmaxRevS) {
+  c.begin(STEP_PIN, DIR_PIN, -1, ENA_ACTIVE_LOW, LIMIT_BOTTOM, true, kStepsPerRev, kOpenTurns);
+  c.setMaxSpeedSteps((vmaxRevS + 0.2f * i) * kStepsPerRev);
+  c.setAccelerationSteps2(4.0f * kStepsPerRev);
+  c.motor.setDirection(1);
+  c.open();
+}
+
+// Mesure le retard des pas émis pendant un passage : le nouveau _nextStepUs vaut
+// instant_du_pas + intervalle, d'où l'instant réel du pas.
+template <uint8_t N, class Pass>
+void runBench(CounterControl* axes, float vmaxRevS, unsigned loopUs, Pass pass, AxisStats* stats) {
+  hostClockUs = 0;
+  for (uint8_t i = 0; i < N; i++) setupAxis(axes[i], i, vmaxRevS);
+  for (;;) {
+    bool moving = false;
+    for (uint8_t i = 0; i < N; i++) moving |= axes[i].isMoving();
+    if (!moving) break;
+
+    unsigned long due[N];
+    long pos[N];
+    for (uint8_t i = 0; i < N; i++) { due[i] = axes[i].motor.nextStepUs(); pos[i] = axes[i].positionSteps(); }
+    pass();
+    hostClockUs += loopUs;
+    for (uint8_t i = 0; i < N; i++) {
+      if (axes[i].positionSteps() == pos[i] || due[i] == 0) continue;
+      unsigned long at = axes[i].motor.nextStepUs() - axes[i].motor.stepIntervalUs();
+      stats[i].late.push_back((long)(at - due[i]));
+    }
+  }
+}
+
+void report(const char* name, uint8_t n, AxisStats* stats) {
+  for (uint8_t i = 0; i < n; i++) {
+    std::vector<long>& v = stats[i].late;
+    std::sort(v.begin(), v.end());
+    auto pct = [&](double p) { return v.empty() ? 0L : v[(size_t)(p * (v.size() - 1))]; };
+    printf("%u  %-13s axe %u  pas %6zu  retard µs p50 %4ld  p99 %4ld  max %4ld\n",
+           n, name, i, v.size(), pct(0.50), pct(0.99), v.empty() ? 0L : v.back());
+  }
+}
+
+template <uint8_t N>
+void benchN(float vmaxRevS, unsigned loopUs) {
+  AxisStats rr[N], sc[N];
+
+  static CounterControl plain[N];
+  for (uint8_t i = 0; i < N; i++) plain[i] = CounterControl();
+  runBench<N>(plain, vmaxRevS, loopUs, [&] { for (uint8_t i = 0; i < N; i++) plain[i].poll(); }, rr);
+
+  static StepScheduler<N> sched;
+  sched = StepScheduler<N>();
+  runBench<N>(&sched.axis(0), vmaxRevS, loopUs, [&] { hostMicrosFreeCalls = 1; sched.poll(); }, sc);
+
+  report("tour complet", N, rr);
+  report("StepScheduler", N, sc);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  hostMicrosCostUs       = argc > 1 ? (unsigned long)atol(argv[1]) : 12UL;
+  const unsigned loopUs  = argc > 2 ? (unsigned)atoi(argv[2]) : 10u;
+  const float vmaxRevS   = argc > 3 ? (float)atof(argv[3]) : 1.6f;
+
+  printf("coût run() %lu µs, loop %u µs, vmax %.2f tr/s (+0.2 par axe), course %.2f tr\n",
+         hostMicrosCostUs, loopUs, vmaxRevS, kOpenTurns);
+  benchN<1>(vmaxRevS, loopUs);
+  benchN<2>(vmaxRevS, loopUs);
+  benchN<3>(vmaxRevS, loopUs);
+  benchN<4>(vmaxRevS, loopUs);
+  return 0;
+}
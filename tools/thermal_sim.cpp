@@ -0,0 +1,155 @@
+// thermal_sim.cpp — simulation hôte de la gestion driver de CounterControl (coupure au repos +
+// déclassement thermique), avec un modèle thermique et un modèle de couple du moteur
+//
+// Thermique : C·dT/dt = P - (T - Tamb)/Rth, P = Pcuivre si ENABLE actif + Pfer·v (tr/s).
+// Couple : tools/host/motor_model.h avec kTemp = 0,01 /°C (A0 12 tr/s², décrochage 3 tr/s).
+// Journée type : trafic normal (pause 60 s), coup de feu (pause 3 s), trafic normal.
+// Trois politiques comparées :
+//   - toujours alimenté, pleine vitesse
+//   - toujours alimenté, vitesse réduite en permanence (réglage prudent actuel)
+//   - coupure au repos (coupure_ms, 10 s par défaut : le firmware l'a désactivée, DRIVER_IDLE_OFF_MS
+//     = 0, faute de tenue de la charge) + déclassement selon kDerateCurve (Config.h)
+// La température est lue toutes les 5 s à l'arrêt, comme loop() avec la Nano.
+//
+// Build (hôte) : g++ -std=c++17 -O2 -Itools/host -I. -o thermal_sim tools/thermal_sim.cpp
+// Usage        : ./thermal_sim [v_tr_s=2.0] [a_tr_s2=1.5] [prudent=0.6] [loop_us=50] [coupure_ms=10000]
+
+#define KISS_TRACE_DEPTH 0
+#include "CounterControl.h"
+#include "motor_model.h"
+
+#include <cstdio>
+
+namespace {
+
+const float spr = (float)kStepsPerRev;
+unsigned long idleOffMs = 10000UL;  // coupure au repos étudiée (politique gérée)
+
+struct Thermal {
+  float tempC = 25.0f, ambientC = 25.0f;
+  float rth = 1.2f, cth = 750.0f;   // °C/W, J/°C (constante de temps 15 min)
+  float pCu = 40.0f, pFe = 4.0f;    // W, W par tr/s
+  void step(bool enabled, float vRevS, float dtS) {
+    float p = (enabled ? pCu : 0.0f) + pFe * vRevS;
+    tempC += (p - (tempC - ambientC) / rth) * dtS / cth;
+  }
+};
+
+struct Phase { const char* name; double durationS, pauseS; };
+const Phase kDay[] = {
+  { "normal",       3600.0, 60.0 },
+  { "coup de feu",  2700.0,  3.0 },
+  { "normal",       1800.0, 60.0 },
+};
+
+struct Result {
+  long moves = 0, lost = 0;
+  double moveS = 0.0, hotS = 0.0, enabledS = 0.0, totalS = 0.0;
+  float maxTempC = 0.0f;
+};
+
+Result runDay(float v, float a, bool manage, unsigned loopUs) {
+  CounterControl ctrl;
+  Thermal th;
+  Motor motor;
+  motor.kTemp = 0.01f;  // moteur chaud = aimants et cuivre moins efficaces
+  hostClockUs = 0;
+  hostPinLevel[LIMIT_BOTTOM] = LOW;
+  ctrl.begin(STEP_PIN, DIR_PIN, ENA_PIN, ENA_ACTIVE_LOW, LIMIT_BOTTOM, true, kStepsPerRev, kOpenTurns);
+  ctrl.setMaxSpeedSteps(v);
+  ctrl.setAccelerationSteps2(a);
+  SpeedZone zones[kDefaultZoneCount];
+  ctrl.setSpeedZones(zones, defaultSpeedZones(zones, kOpenTurns));
+  if (manage) {
+    ctrl.setDriverIdle(idleOffMs, DRIVER_SETTLE_MS);
+    ctrl.setDerateCurve(kDerateCurve, kDerateCurveLen);
+  }
+
+  Result r;
+  const unsigned long idleStepUs = 10000;  // pas de temps à l'arrêt
+  unsigned long lastTempMs = 0;
+  bool opening = true;
+  for (const Phase& ph : kDay) {
+    const unsigned long phaseEnd = hostClockUs + (unsigned long)(ph.durationS * 1e6);
+    unsigned long nextMoveUs = hostClockUs;
+    while ((long)(hostClockUs - phaseEnd) < 0) {
+      if (!ctrl.isMoving() && (long)(hostClockUs - nextMoveUs) >= 0) {
+        ctrl.motor.setDirection(opening ? 1 : -1);
+        if (opening) ctrl.open(); else ctrl.close();
+        opening = !opening;
+        r.moves++;
+      }
+
+      const bool moving = ctrl.isMoving();
+      const unsigned long dtUs = moving ? loopUs : idleStepUs;
+      ctrl.pollInputs();
+      if (moving && !ctrl.settling()) {
+        long before = ctrl.positionSteps();
+        if (ctrl.motor.run()) motor.onStep((int)(ctrl.positionSteps() - before), ctrl.motor.speed(), th.tempC);
+      }
+      hostPinLevel[LIMIT_BOTTOM] = motor.phys <= 0 ? LOW : HIGH;
+
+      const bool enabled = ctrl.driverEnabled();
+      th.step(enabled, fabsf(ctrl.motor.speed()) / spr, dtUs * 1e-6f);
+      hostClockUs += dtUs;
+
+      const double dtS = dtUs * 1e-6;
+      r.totalS += dtS;
+      if (moving) r.moveS += dtS;
+      if (enabled) r.enabledS += dtS;
+      if (th.tempC > 60.0f) r.hotS += dtS;
+      if (th.tempC > r.maxTempC) r.maxTempC = th.tempC;
+
+      if (moving && !ctrl.isMoving()) {
+        // Fin de mouvement : pas perdus comptés puis charge recalée (homing implicite)
+        r.lost += motor.lost;
+        motor.lost = 0;
+        motor.stalled = false;
+        motor.phys = ctrl.positionSteps();
+        nextMoveUs = hostClockUs + (unsigned long)(ph.pauseS * 1e6);
+      }
+      // Lecture Nano toutes les 5 s, seulement à l'arrêt (comme loop())
+      if (!ctrl.isMoving() && millis() - lastTempMs >= 5000UL) {
+        ctrl.setTemperature(th.tempC);
+        lastTempMs = millis();
+      }
+    }
+  }
+  return r;
+}
+
+void print(const char* name, const Result& r) {
+  printf("%-34s %6ld %9.2f %8.1f %10.0f %12.0f %10ld\n", name, r.moves, r.moveS / r.moves, r.maxTempC,
+         r.hotS, 100.0 * r.enabledS / r.totalS, r.lost);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const float vRevS    = argc > 1 ? (float)atof(argv[1]) : 2.0f;
+  const float aRevS2   = argc > 2 ? (float)atof(argv[2]) : 1.5f;
+  const float prudent  = argc > 3 ? (float)atof(argv[3]) : 0.6f;
+  const unsigned loopUs = argc > 4 ? (unsigned)atoi(argv[4]) : 50u;
+  if (argc > 5) idleOffMs = strtoul(argv[5], nullptr, 10);
+
+  printf("pleine vitesse %.2f tr/s, %.2f tr/s² ; prudent x%.2f ; coupure après %lu ms, réactivation %lu ms\n",
+         vRevS, aRevS2, prudent, idleOffMs, DRIVER_SETTLE_MS);
+  printf("courbe :");
+  for (uint8_t i = 0; i < kDerateCurveLen; i++) printf(" %.0f °C→x%.2f", kDerateCurve[i].tempC, kDerateCurve[i].factor);
+  printf("\njournée :");
+  for (const Phase& ph : kDay) printf(" %s %.0f min (pause %.0f s)", ph.name, ph.durationS / 60.0, ph.pauseS);
+  printf("\n\n%-34s %6s %9s %8s %10s %12s %10s\n", "politique", "mouv.", "s/mouv.", "T max", "s > 60 °C", "% alimenté", "pas perdus");
+
+  Result full = runDay(vRevS * spr, aRevS2 * spr, false, loopUs);
+  Result slow = runDay(vRevS * prudent * spr, aRevS2 * prudent * spr, false, loopUs);
+  Result mgd  = runDay(vRevS * spr, aRevS2 * spr, true, loopUs);
+  print("toujours alimenté, pleine vitesse", full);
+  print("toujours alimenté, prudent", slow);
+  print("coupure au repos + déclassement", mgd);
+
+  // Attendu : aucune perte de pas, plus froid et plus rapide que le réglage prudent permanent
+  bool ok = mgd.lost == 0 && mgd.maxTempC < full.maxTempC && mgd.moveS / mgd.moves < slow.moveS / slow.moves;
+  printf("%s\n", ok ? "OK : aucune perte, moteur plus froid, mouvements plus rapides que le réglage prudent"
+                    : "ÉCHEC : pertes de pas, ou pas de gain thermique / de vitesse");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// trace_analyze.cpp — analyse hors-ligne d'une trace StepperKiss (/trace.bin)
+//
+// Reconstruit position, vitesse et accélération pas à pas, puis signale les pas
+// dont l'intervalle s'écarte trop de ses voisins (jitter de loop()).
+//
+// Build (hôte) : g++ -std=c++17 -O2 -o trace_analyze tools/trace_analyze.cpp
+// Usage        : ./trace_analyze trace.bin [seuil_relatif=0.25] > profil.csv
+//
+// Sortie CSV (stdout) : t_us,pos,phase,interval_us,v_sps,a_sps2,outlier
+// Les marques FSM sont émises en lignes "# mark t_us state". Résumé sur stderr.
+// Format CSV simple, pour superposer une trace terrain à un profil simulé.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const uint32_t kDtMask   = 0x00FFFFFFUL;
+const uint32_t kMark     = 1UL << 28;
+const uint32_t kDirPos   = 1UL << 27;
+const char*    kPhases[] = { "accel", "cruise", "decel", "?" };
+const char*    kStates[] = { "BOOT", "HOMING_START", "HOMING_RUN", "IDLE", "OPENING",
+                             "CLOSING", "STOPPING", "FAULT", "MEASURE", "AUTOTUNE" };
+
+uint32_t le32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+struct Step {
+  double tUs;
+  long pos;
+  unsigned phase;
+  double intervalUs;  // 0 si premier pas après une marque / une pause
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s trace.bin [seuil_relatif]\n", argv[0]);
+    return 2;
+  }
+  const double threshold = (argc > 2) ? atof(argv[2]) : 0.25;
+
+  FILE* f = fopen(argv[1], "rb");
+  if (!f) { perror(argv[1]); return 1; }
+  std::vector<uint8_t> buf;
+  uint8_t tmp[4096];
+  size_t n;
+  while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0) buf.insert(buf.end(), tmp, tmp + n);
+  fclose(f);
+
+  if (buf.size() < 16 || memcmp(buf.data(), "KTR1", 4) != 0) {
+    fprintf(stderr, "%s: en-tête KTR1 absent\n", argv[1]);
+    return 1;
+  }
+  const unsigned count = (unsigned)buf[4] | ((unsigned)buf[5] << 8);
+  const uint32_t dropped = le32(&buf[8]);
+  const uint32_t stepsPerRev = le32(&buf[12]);
+  if (buf.size() < 16 + (size_t)count * 4) {
+    fprintf(stderr, "%s: tronqué (%u événements annoncés)\n", argv[1], count);
+    return 1;
+  }
+
+  // Un intervalle plus long que ce plafond = moteur à l'arrêt, pas un pas de profil
+  const double kPauseUs = 50000.0;
+
+  std::vector<Step> steps;
+  double t = 0.0;
+  long pos = 0;
+  bool fresh = true;
+  printf("t_us,pos,phase,interval_us,v_sps,a_sps2,outlier\n");
+  for (unsigned i = 0; i < count; i++) {
+    uint32_t ev = le32(&buf[16 + 4 * i]);
+    double dt = (double)(ev & kDtMask);
+    t += (i == 0) ? 0.0 : dt;
+    if (ev & kMark) {
+      unsigned code = (ev >> 24) & 0x0F;
+      printf("# mark %.0f %s\n", t, code < sizeof(kStates) / sizeof(kStates[0]) ? kStates[code] : "?");
+      fresh = true;
+      continue;
+    }
+    pos += (ev & kDirPos) ? 1 : -1;
+    bool pause = fresh || i == 0 || dt > kPauseUs;
+    steps.push_back({ t, pos, (ev >> 24) & 0x03, pause ? 0.0 : dt });
+    fresh = false;
+  }
+
+  // Jitter : écart entre l'intervalle d'un pas et la moyenne de ses deux voisins.
+  // Le profil accel/décel varie lentement d'un pas à l'autre, un écart brusque vient de loop().
+  std::vector<double> jitter;
+  unsigned outliers = 0;
+  double vPrev = 0.0, vMax = 0.0, tPrev = 0.0;
+  for (size_t i = 0; i < steps.size(); i++) {
+    const Step& s = steps[i];
+    double v = s.intervalUs > 0.0 ? 1e6 / s.intervalUs : 0.0;
+    double a = (s.intervalUs > 0.0 && vPrev > 0.0) ? (v - vPrev) / ((s.tUs - tPrev) * 1e-6) : 0.0;
+    bool outlier = false;
+    if (i > 0 && i + 1 < steps.size() && s.intervalUs > 0.0
+        && steps[i - 1].intervalUs > 0.0 && steps[i + 1].intervalUs > 0.0) {
+      double expected = 0.5 * (steps[i - 1].intervalUs + steps[i + 1].intervalUs);
+      double dev = s.intervalUs - expected;
+      jitter.push_back(fabs(dev));
+      outlier = fabs(dev) > threshold * expected;
+      if (outlier) outliers++;
+    }
+    if (v > vMax) vMax = v;
+    printf("%.0f,%ld,%s,%.0f,%.1f,%.1f,%d\n", s.tUs, s.pos, kPhases[s.phase], s.intervalUs, v, a, outlier ? 1 : 0);
+    vPrev = v;
+    tPrev = s.tUs;
+  }
+
+  std::sort(jitter.begin(), jitter.end());
+  auto pct = [&](double p) { return jitter.empty() ? 0.0 : jitter[(size_t)(p * (jitter.size() - 1))]; };
+  fprintf(stderr, "événements: %u (écrasés: %u), pas: %zu, durée: %.3f s\n",
+          count, (unsigned)dropped, steps.size(), t * 1e-6);
+  fprintf(stderr, "vitesse max: %.0f pas/s (%.3f tr/s)\n", vMax, stepsPerRev ? vMax / stepsPerRev : 0.0);
+  fprintf(stderr, "jitter |dt - voisins| µs : p50 %.0f  p99 %.0f  max %.0f\n",
+          pct(0.50), pct(0.99), jitter.empty() ? 0.0 : jitter.back());
+  fprintf(stderr, "pas hors tolérance (>%.0f %%): %u\n", threshold * 100.0, outliers);
+  return 0;
+}
@@ -0,0 +1,333 @@
+// webui_load.cpp — banc de charge HTTP de WebUI sur PC
+//
+// Le firmware complet (PJ_001_ESP8266.ino + WebUI.cpp) tourne dans un thread : setup() puis
+// loop() en boucle, horloge réelle, serveur ESP8266WebServer (hôte) sur 127.0.0.1:port.
+// Banc physique minimal : la position réelle suit les fronts STEP/DIR, le fin de course (actif
+// bas) est enfoncé à 0 et en dessous ; la Nano répond $TMP/$DST sur le port série.
+// Des clients (un thread chacun, une connexion par requête) rejouent des profils de trafic :
+//   - tablette  : /status, /logs, /cycles en revalidation If-None-Match (ETag gardé par route)
+//   - automate  : POST /cmd ouverture + fermeture, suivi /done?id jusqu'à la fin (pause x4,
+//                 "running" pendant la course), /status, puis repos (pause x40)
+//   - opérateur : /set (vitesse/accélération), /open, /close, pause x10
+// Rapport : requêtes/s, latence client p50/p90/p99/max par route, 200/304, durée du handler,
+// allocations et octets par requête côté serveur, et retard des pas moteur (instant réel du
+// front STEP - échéance planifiée par StepperKiss) pendant les mouvements.
+// Un percentile n'est affiché qu'avec assez d'échantillons (p90 : 10, p99 : 100, p99.9 : 1000),
+// sinon "-" et un avertissement liste les routes à mesurer plus longtemps.
+//
+// Build (hôte) : g++ -std=c++17 -O2 -pthread -DHOST_REAL_CLOCK -Itools/host -I. -o webui_load tools/webui_load.cpp WebUI.cpp
+// Usage        : ./webui_load [durée_s=60] [tablettes=3] [automates=1] [opérateurs=1] [pause_ms=50] [port=8080] [ui_en_mouvement=0]
+// ui_en_mouvement=1 : le banc sert HTTP à chaque passage de loop() pendant les mouvements (sinon
+// rien avec un seul axe, WEBUI_SERVE_WHILE_MOVING), pour chiffrer ce que cette porte protège.
+
+#include "PJ_001_ESP8266.ino"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Allocations du thread courant (lues par le serveur hôte autour de chaque handler)
+void* operator new(size_t n) {
+  hostAllocCount++;
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+// ---------------- Banc physique (thread firmware) ----------------
+const long kStartAboveSwitch = 200;   // pas au-dessus du fin de course au démarrage
+
+long physPos = kStartAboveSwitch;
+bool dirHigh = false;
+std::vector<long> stepLateUs;
+
+void onPin(uint8_t pin, uint8_t level) {
+  if (pin == DIR_PIN) { dirHigh = level == HIGH; return; }
+  if (pin != STEP_PIN || level != HIGH) return;
+  physPos += dirHigh ? 1 : -1;
+  hostPinLevel[LIMIT_BOTTOM] = physPos <= 0 ? LOW : HIGH;
+  unsigned long due = sched.axis(0).motor.nextStepUs();  // encore l'échéance du pas en cours
+  if (due) stepLateUs.push_back((long)(micros() - due));
+}
+
+void onSerial(uint8_t c) {
+  if (c == 'T') hostSerialFeed("$TMP:38.5\r\n");
+  else if (c == 'D') hostSerialFeed("$DST:12.0\r\n");
+}
+
+// Côté serveur, par route (thread firmware)
+struct ServerStats {
+  unsigned long n = 0, handlerUs = 0, allocs = 0;
+  size_t bytes = 0;
+};
+std::map<std::string, ServerStats> serverStats;
+
+void onHttp(const HostHttpRecord& r) {
+  ServerStats& s = serverStats[r.path];
+  s.n++;
+  s.handlerUs += r.handlerUs;
+  s.allocs += r.allocs;
+  s.bytes += r.bytes;
+}
+
+std::atomic<bool> fwReady{ false }, fwIdle{ false }, fwStop{ false }, clientsStop{ false };
+std::atomic<bool> measureReq{ false }, measuring{ false };
+bool serveWhileMoving = false;
+unsigned long cycles0 = 0;
+
+// Les compteurs ne sont remis à zéro que par ce thread, au début de la fenêtre de mesure
+void firmwareThread() {
+  setup();
+  fwReady = true;
+  while (!fwStop) {
+    loop();
+    if (serveWhileMoving && sched.anyMoving()) WebUI::loop();
+    if (measureReq && !measuring) {
+      serverStats.clear();
+      stepLateUs.clear();
+      cycles0 = axes[0].cycles;
+      measuring = true;
+    }
+    fwIdle = axes[0].st == State::IDLE;
+  }
+}
+
+// ---------------- Clients HTTP ----------------
+struct Resp {
+  int code = 0;
+  std::string etag, body;
+};
+
+bool httpRequest(const std::string& req, Resp& out) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_port = htons((uint16_t)hostHttpPort);
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::connect(fd, (sockaddr*)&a, sizeof(a)) < 0) { ::close(fd); return false; }
+  ::send(fd, req.data(), req.size(), MSG_NOSIGNAL);
+
+  std::string raw;
+  char buf[4096];
+  for (;;) {
+    pollfd pfd = { fd, POLLIN, 0 };
+    if (::poll(&pfd, 1, 60000) <= 0) break;   // une course dure quelques secondes au plus
+    ssize_t r = ::recv(fd, buf, sizeof(buf), 0);
+    if (r <= 0) break;
+    raw.append(buf, (size_t)r);
+  }
+  ::close(fd);
+
+  size_t headEnd = raw.find("\r\n\r\n");
+  if (raw.compare(0, 9, "HTTP/1.1 ") != 0 || headEnd == std::string::npos) return false;
+  out.code = atoi(raw.c_str() + 9);
+  size_t e = raw.find("\r\nETag: ");
+  out.etag = (e != std::string::npos && e < headEnd) ? raw.substr(e + 8, raw.find("\r\n", e + 8) - e - 8) : std::string();
+  out.body = raw.substr(headEnd + 4);
+  return true;
+}
+
+struct PathStats {
+  std::vector<long> latUs;
+  unsigned long n200 = 0, n304 = 0, nOther = 0, nFail = 0;
+};
+
+class Client {
+public:
+  Client(unsigned seed, unsigned pauseMs) : _rng(seed), _pauseMs(pauseMs) {}
+
+  // GET avec revalidation : l'ETag reçu est renvoyé à la requête suivante de la même route
+  Resp get(const char* route, const std::string& target, bool revalidate = false) {
+    std::string req = "GET " + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    std::string& tag = _etags[target];
+    if (revalidate && !tag.empty()) req += "If-None-Match: " + tag + "\r\n";
+    req += "\r\n";
+    Resp r = timed(route, req);
+    if (revalidate && r.code == 200 && !r.etag.empty()) tag = r.etag;
+    return r;
+  }
+
+  Resp post(const char* route, const std::string& target, const std::string& body) {
+    std::string req = "POST " + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/json\r\n"
+                      "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    return timed(route, req);
+  }
+
+  void pause(unsigned factor = 1) {
+    std::uniform_int_distribution<unsigned> d(_pauseMs * factor / 2, _pauseMs * factor * 3 / 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(d(_rng)));
+  }
+  unsigned rand(unsigned lo, unsigned hi) { return std::uniform_int_distribution<unsigned>(lo, hi)(_rng); }
+
+  std::map<std::string, PathStats> stats;
+
+private:
+  Resp timed(const char* route, const std::string& req) {
+    Resp r;
+    unsigned long t0 = micros();
+    bool ok = httpRequest(req, r);
+    PathStats& s = stats[route];
+    if (!ok) { s.nFail++; return r; }
+    s.latUs.push_back((long)(micros() - t0));
+    if (r.code == 200) s.n200++;
+    else if (r.code == 304) s.n304++;
+    else s.nOther++;
+    return r;
+  }
+
+  std::mt19937 _rng;
+  unsigned _pauseMs;
+  std::map<std::string, std::string> _etags;
+};
+
+void tabletThread(Client* c) {
+  while (!clientsStop) {
+    unsigned r = c->rand(0, 99);
+    if (r < 60)      c->get("/status", "/status?axis=0", true);
+    else if (r < 90) c->get("/logs", "/logs", true);
+    else             c->get("/cycles", "/cycles?axis=0", true);
+    c->pause();
+  }
+}
+
+void automateThread(Client* c) {
+  while (!clientsStop) {
+    Resp r = c->post("/cmd", "/cmd?axis=0", "{\"ops\":[{\"op\":\"open\"},{\"op\":\"close\"}]}");
+    size_t comma = r.body.find(',');
+    if (r.code != 200 || comma == std::string::npos) { c->pause(10); continue; }   // file pleine
+    std::string lastId = std::to_string(atol(r.body.c_str() + comma + 1));
+    for (unsigned i = 0; !clientsStop; i++) {
+      c->pause(4);
+      Resp d = c->get("/done", "/done?id=" + lastId);
+      bool pending = d.body.find("\"queued\"") != std::string::npos || d.body.find("\"running\"") != std::string::npos;
+      if (d.code != 200 || !pending) break;
+      if (i % 5 == 4) c->get("/status", "/status?axis=0", true);
+    }
+    c->pause(40);   // machine au repos entre deux cycles
+  }
+}
+
+void operatorThread(Client* c) {
+  while (!clientsStop) {
+    unsigned r = c->rand(0, 99);
+    if (r < 60) c->get("/set", "/set?axis=0&speed=" + std::to_string(c->rand(1600, 3200)) + "&accel=" + std::to_string(c->rand(2000, 6000)));
+    else if (r < 80) c->get("/open", "/open?axis=0");
+    else c->get("/close", "/close?axis=0");
+    c->pause(10);
+  }
+}
+
+long pct(const std::vector<long>& v, double p) { return v.empty() ? 0L : v[(size_t)(p * (v.size() - 1))]; }
+
+// Échantillons minimum pour qu'un percentile ne soit pas simplement le max (ou presque)
+const size_t kMinP90 = 10, kMinP99 = 100, kMinP999 = 1000;
+
+// Percentile en ms dans b, "-" si l'échantillon est trop petit
+const char* pctMs(char* b, size_t n, const std::vector<long>& v, double p, size_t minN) {
+  if (v.size() < minN) snprintf(b, n, "-");
+  else snprintf(b, n, "%.2f", pct(v, p) / 1e3);
+  return b;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const double durationS   = argc > 1 ? atof(argv[1]) : 60.0;
+  const unsigned tablets   = argc > 2 ? (unsigned)atoi(argv[2]) : 3u;
+  const unsigned automates = argc > 3 ? (unsigned)atoi(argv[3]) : 1u;
+  const unsigned operators = argc > 4 ? (unsigned)atoi(argv[4]) : 1u;
+  const unsigned pauseMs   = argc > 5 ? (unsigned)atoi(argv[5]) : 50u;
+  hostHttpPort             = argc > 6 ? atoi(argv[6]) : 8080;
+  serveWhileMoving         = argc > 7 && atoi(argv[7]) != 0;
+
+  hostPinHook = onPin;
+  hostSerialHook = onSerial;
+  hostHttpHook = onHttp;
+  stepLateUs.reserve(1u << 20);
+
+  std::thread fw(firmwareThread);
+  while (!fwReady) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // Profil réaliste avant mesure (le défaut de Config.h accélère à 80 pas/s²) ; attend la fin du homing
+  Client setupClient(0, pauseMs);
+  setupClient.get("/set", "/set?axis=0&speed=2400&accel=4000");
+  while (!fwIdle) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  measureReq = true;
+  while (!measuring) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  std::vector<Client*> clients;
+  std::vector<std::thread> threads;
+  unsigned seed = 1;
+  for (unsigned i = 0; i < tablets; i++)   { clients.push_back(new Client(seed++, pauseMs)); threads.emplace_back(tabletThread, clients.back()); }
+  for (unsigned i = 0; i < automates; i++) { clients.push_back(new Client(seed++, pauseMs)); threads.emplace_back(automateThread, clients.back()); }
+  for (unsigned i = 0; i < operators; i++) { clients.push_back(new Client(seed++, pauseMs)); threads.emplace_back(operatorThread, clients.back()); }
+
+  const unsigned long t0 = micros();
+  std::this_thread::sleep_for(std::chrono::milliseconds((long)(durationS * 1000.0)));
+  clientsStop = true;
+  for (std::thread& t : threads) t.join();
+  const double elapsedS = (micros() - t0) / 1e6;
+  fwStop = true;
+  fw.join();
+
+  // ---------------- Rapport ----------------
+  std::map<std::string, PathStats> all;
+  for (Client* c : clients) {
+    for (auto& kv : c->stats) {
+      PathStats& d = all[kv.first];
+      d.latUs.insert(d.latUs.end(), kv.second.latUs.begin(), kv.second.latUs.end());
+      d.n200 += kv.second.n200; d.n304 += kv.second.n304; d.nOther += kv.second.nOther; d.nFail += kv.second.nFail;
+    }
+    delete c;
+  }
+
+  printf("durée %.1f s, %u tablette(s), %u automate(s), %u opérateur(s), pause %u ms, UI pendant mouvement : %s\n",
+         elapsedS, tablets, automates, operators, pauseMs, serveWhileMoving ? "chaque passage" : "par tranches");
+  printf("%-8s %6s %7s %5s %5s %5s %8s %8s %8s %8s %9s %8s %8s\n",
+         "route", "req", "req/s", "200", "304", "autre", "p50 ms", "p90 ms", "p99 ms", "max ms", "handler µs", "alloc/req", "o/req");
+  PathStats total;
+  std::string fewP90, fewP99;
+  char b50[16], b90[16], b99[16];
+  for (auto& kv : all) {
+    PathStats& s = kv.second;
+    std::sort(s.latUs.begin(), s.latUs.end());
+    total.latUs.insert(total.latUs.end(), s.latUs.begin(), s.latUs.end());
+    total.n200 += s.n200; total.n304 += s.n304; total.nOther += s.nOther; total.nFail += s.nFail;
+    const ServerStats& sv = serverStats[kv.first];
+    double n = sv.n ? (double)sv.n : 1.0;
+    printf("%-8s %6zu %7.1f %5lu %5lu %5lu %8s %8s %8s %8.2f %9.1f %8.1f %8.0f\n",
+           kv.first.c_str(), s.latUs.size(), s.latUs.size() / elapsedS, s.n200, s.n304, s.nOther + s.nFail,
+           pctMs(b50, sizeof(b50), s.latUs, 0.50, 1), pctMs(b90, sizeof(b90), s.latUs, 0.90, kMinP90),
+           pctMs(b99, sizeof(b99), s.latUs, 0.99, kMinP99),
+           s.latUs.empty() ? 0.0 : s.latUs.back() / 1e3, sv.handlerUs / n, sv.allocs / n, sv.bytes / n);
+    if (s.latUs.size() < kMinP90) fewP90 += " " + kv.first;
+    else if (s.latUs.size() < kMinP99) fewP99 += " " + kv.first;
+  }
+  std::sort(total.latUs.begin(), total.latUs.end());
+  unsigned long svN = 0, svAllocs = 0;
+  for (auto& kv : serverStats) { svN += kv.second.n; svAllocs += kv.second.allocs; }
+  printf("%-8s %6zu %7.1f %5lu %5lu %5lu %8s %8s %8s %8.2f %9s %8.1f\n",
+         "total", total.latUs.size(), total.latUs.size() / elapsedS, total.n200, total.n304, total.nOther + total.nFail,
+         pctMs(b50, sizeof(b50), total.latUs, 0.50, 1), pctMs(b90, sizeof(b90), total.latUs, 0.90, kMinP90),
+         pctMs(b99, sizeof(b99), total.latUs, 0.99, kMinP99),
+         total.latUs.empty() ? 0.0 : total.latUs.back() / 1e3, "", svN ? (double)svAllocs / svN : 0.0);
+  if (!fewP90.empty()) printf("ATTENTION : moins de %zu requêtes, p90/p99 non significatifs :%s\n", kMinP90, fewP90.c_str());
+  if (!fewP99.empty()) printf("ATTENTION : moins de %zu requêtes, p99 non significatif :%s\n", kMinP99, fewP99.c_str());
+  if (!fewP90.empty() || !fewP99.empty()) printf("            (allonger durée_s ou ajouter des clients)\n");
+
+  std::sort(stepLateUs.begin(), stepLateUs.end());
+  printf("pas moteur : %zu pas, %lu course(s) complètes, retard µs p50 %ld  p99 %ld  p99.9 ",
+         stepLateUs.size(), axes[0].cycles - cycles0, pct(stepLateUs, 0.50), pct(stepLateUs, 0.99));
+  if (stepLateUs.size() >= kMinP999) printf("%ld", pct(stepLateUs, 0.999));
+  else printf("-");
+  printf("  max %ld\n", stepLateUs.empty() ? 0L : stepLateUs.back());
+  if (stepLateUs.size() < kMinP99) printf("ATTENTION : moins de %zu pas mesurés, retard p99 non significatif\n", kMinP99);
+  return 0;
+}
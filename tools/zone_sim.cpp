@@ -0,0 +1,116 @@
+// zone_sim.cpp — simulation hôte des zones de vitesse (CounterControl + StepperKiss réels)
+//
+// Compare le temps d'un cycle ouverture + fermeture de kOpenTurns tours :
+//   - profil unique : toute la course à la vitesse sûre des extrémités
+//   - profil à zones : même vitesse dans les ZONE_END_TURNS extrêmes, vmid au milieu
+// et vérifie que la vitesse en zone d'extrémité ne dépasse jamais la vitesse sûre.
+//
+// Build (hôte) : g++ -std=c++17 -O2 -Itools/host -I. -o zone_sim tools/zone_sim.cpp
+// Usage        : ./zone_sim [vmid_tr_s=1.6] [accel_tr_s2=2.0] [loop_us=20] [trace.bin]
+// Le profil à zones peut être écrit au format /trace.bin pour tools/trace_analyze.
+// Anneau de 16384 événements : la course entière, que le firmware (1024, Config.h) ne garde pas.
+
+#define KISS_TRACE_DEPTH 16384
+#include "CounterControl.h"
+
+#include <cstdio>
+
+namespace {
+
+struct Result {
+  double openS, closeS;
+  float maxEndSps;   // vitesse max observée dans les zones d'extrémité
+  float minMidSps;   // vitesse min observée en milieu de course (0 = arrêt)
+};
+
+CounterControl ctrl;
+
+// Fait tourner poll() jusqu'à la fin du mouvement ; loopUs = coût d'un tour de loop()
+double runMove(bool opening, unsigned loopUs, float endTurns, float openTurns, Result& r) {
+  const unsigned long t0 = hostClockUs;
+  ctrl.motor.setDirection(opening ? 1 : -1);
+  if (opening) ctrl.open(); else ctrl.close();
+  while (ctrl.isMoving()) {
+    ctrl.poll();
+    hostClockUs += loopUs;
+    float pos = ctrl.positionTurns();
+    float v = fabsf(ctrl.motor.speed());
+    bool inEnd = pos <= endTurns || pos >= openTurns - endTurns;
+    if (inEnd) { if (v > r.maxEndSps) r.maxEndSps = v; }
+    else if (v < r.minMidSps) r.minMidSps = v;
+  }
+  return (hostClockUs - t0) * 1e-6;
+}
+
+Result runCycle(float vmidSps, float endSps, float accelSps2, unsigned loopUs, bool zones) {
+  ctrl = CounterControl();
+  ctrl.begin(STEP_PIN, DIR_PIN, ENA_PIN, ENA_ACTIVE_LOW, LIMIT_BOTTOM, true, kStepsPerRev, kOpenTurns);
+  ctrl.setMaxSpeedSteps(zones ? vmidSps : endSps);
+  ctrl.setAccelerationSteps2(accelSps2);
+  SpeedZone table[kDefaultZoneCount];
+  const uint8_t n = defaultSpeedZones(table, kOpenTurns);  // table du firmware (extrémités à endSps)
+  ctrl.setSpeedZones(table, zones ? n : 0);
+  ctrl.motor.traceEnable(true);
+
+  Result r{ 0.0, 0.0, 0.0f, 1e9f };
+  r.openS  = runMove(true,  loopUs, ZONE_END_TURNS, kOpenTurns, r);
+  r.closeS = runMove(false, loopUs, ZONE_END_TURNS, kOpenTurns, r);
+  return r;
+}
+
+void putLe32(FILE* f, uint32_t v) {
+  uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+  fwrite(b, 1, 4, f);
+}
+
+bool writeTrace(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) { perror(path); return false; }
+  uint16_t n = ctrl.motor.traceCount();
+  uint8_t hdr[8] = { 'K', 'T', 'R', '1', (uint8_t)n, (uint8_t)(n >> 8), 0, 0 };
+  fwrite(hdr, 1, sizeof(hdr), f);
+  putLe32(f, ctrl.motor.traceDropped());
+  putLe32(f, (uint32_t)kStepsPerRev);
+  uint32_t w[256];
+  for (uint16_t from = 0, got; (got = ctrl.motor.traceRead(from, w, 256)) > 0; from += got)
+    for (uint16_t i = 0; i < got; i++) putLe32(f, w[i]);
+  fclose(f);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const float vmidRevS  = argc > 1 ? (float)atof(argv[1]) : 1.6f;
+  const float accelRevS = argc > 2 ? (float)atof(argv[2]) : 2.0f;
+  const unsigned loopUs = argc > 3 ? (unsigned)atoi(argv[3]) : 20u;
+  const char* tracePath = argc > 4 ? argv[4] : nullptr;
+
+  const float endSps   = ZONE_END_VMAX_REV_S * kStepsPerRev;
+  const float vmidSps  = vmidRevS * kStepsPerRev;
+  const float accelSps = accelRevS * kStepsPerRev;
+
+  printf("course %.2f tr, zones d'extrémité %.2f tr à %.2f tr/s, milieu %.2f tr/s, accel %.2f tr/s², loop %u µs\n",
+         kOpenTurns, ZONE_END_TURNS, ZONE_END_VMAX_REV_S, vmidRevS, accelRevS, loopUs);
+
+  Result single = runCycle(vmidSps, endSps, accelSps, loopUs, false);
+  Result zoned  = runCycle(vmidSps, endSps, accelSps, loopUs, true);
+  if (tracePath && !writeTrace(tracePath)) return 1;
+
+  printf("%-14s %9s %9s %9s %16s %16s\n", "profil", "ouvr. s", "ferm. s", "cycle s", "v max ext. tr/s", "v min mil. tr/s");
+  const Result* rs[] = { &single, &zoned };
+  const char* names[] = { "vitesse unique", "zones" };
+  for (int i = 0; i < 2; i++)
+    printf("%-14s %9.3f %9.3f %9.3f %16.3f %16.3f\n", names[i], rs[i]->openS, rs[i]->closeS,
+           rs[i]->openS + rs[i]->closeS, rs[i]->maxEndSps / kStepsPerRev, rs[i]->minMidSps / kStepsPerRev);
+
+  double gain = 1.0 - (zoned.openS + zoned.closeS) / (single.openS + single.closeS);
+  printf("gain de temps de cycle : %.1f %%\n", gain * 100.0);
+
+  // Contrôles : vitesse sûre respectée aux extrémités (à un pas d'intégration près, 1 %),
+  // pas d'arrêt aux frontières de zone
+  bool ok = zoned.maxEndSps <= endSps * 1.01f && zoned.minMidSps > 0.5f * endSps;
+  printf("%s\n", ok ? "OK : extrémités à la vitesse sûre, pas d'arrêt aux frontières"
+                    : "ÉCHEC : vitesse d'extrémité dépassée ou arrêt en milieu de course");
+  return ok ? 0 : 1;
+}